@@ -0,0 +1,139 @@
+// AutoDLOSolver.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "AutoDLOSolver.h"
+
+#include "Domain.h"
+
+#include <chrono>
+#include <cstring>
+
+CAutoDLOSolver::CAutoDLOSolver():
+	mBackend( nullptr ),
+	mChoice( { eLPBackend::CLP, eLPAlgorithm::BARRIER, false } ),
+	mNonzeros( 0 )
+{
+#ifdef DLO_WITH_HIGHS
+	mSelector.SetAvailable( eLPBackend::HIGHS, true );
+#endif
+}
+
+double
+CAutoDLOSolver::Solve( CDomain* Domain )
+{
+	mDomain = Domain;
+	mBackend = nullptr;
+	mNonzeros = 0;
+	mSamples.clear();
+
+	mCoin.mDomain = Domain;
+	mCoin.fResetModel();
+#ifdef DLO_WITH_HIGHS
+	mHighs.mDomain = Domain;
+	mHighs.fBuildModel();
+#endif
+
+	return CDLOSolver::Solve( Domain );
+}
+
+sLPFeatures
+CAutoDLOSolver::fGetFeatures()
+{
+	sLPFeatures Result;
+
+	Result.Iteration = static_cast<int>(mStats.size()) + 1;
+	Result.Nodes = mDomain->mNodes.size();
+	Result.ActiveEdges = 0;
+	Result.Nonzeros = 0;
+
+	// Upper estimate: 6 compatibility entries, the yield row and the work row
+	// per displacement column, plus the two plastic multipliers
+	for ( auto Edge : mActiveEdges )
+	{
+		if ( Edge->Added )
+		{
+			++Result.ActiveEdges;
+			Result.Nonzeros += Edge->DOF() * 8;
+
+			if ( Edge->Type != eEdgeType::FREE &&
+				 Edge->Type != eEdgeType::SIMPLE_ANCHORED )
+				Result.Nonzeros += 2;
+		}
+	}
+
+	Result.NewNonzeros = Result.Nonzeros > mNonzeros ? Result.Nonzeros - mNonzeros : 0;
+
+	// Only the HiGHS model survives between iterations, and only a simplex or
+	// crossover leaves a basis behind
+	Result.WarmStart = mBackend &&
+		mChoice.Backend == eLPBackend::HIGHS &&
+		mChoice.Algorithm != eLPAlgorithm::FIRST_ORDER;
+	Result.WarmBackend = mChoice.Backend;
+
+	return Result;
+}
+
+double*
+CAutoDLOSolver::fSolve( double& Objective )
+{
+	sLPFeatures Features = fGetFeatures();
+	sLPChoice Choice = mSelector.Select( Features );
+
+	CDLOSolver* Backend = &mCoin;
+	mCoin.SetAlgorithm( Choice.Algorithm );
+	mCoin.mTolerance = mTolerance;
+
+#ifdef DLO_WITH_HIGHS
+	if ( Choice.Backend == eLPBackend::HIGHS )
+	{
+		Backend = &mHighs;
+		mHighs.mTolerance = mTolerance;
+		mHighs.SetAlgorithm( Choice.Warm ? eLPAlgorithm::DUAL_SIMPLEX : Choice.Algorithm );
+	}
+#endif
+
+	Backend->mActiveEdges = mActiveEdges;
+	Backend->mDOFOffsets = mDOFOffsets;
+	Backend->mYieldOffsets = mYieldOffsets;
+
+	auto Start = std::chrono::steady_clock::now();
+
+	// The backend returns duals from its own arena
+	Backend->mArena.Reset();
+
+	double* Result = Backend->fSolve( Objective );
+
+	std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+	sLPSample Sample;
+	Sample.Choice = Choice;
+	Sample.Size = static_cast<double>(Choice.Warm ? Features.NewNonzeros : Features.Nonzeros);
+	Sample.Time = Elapsed.count();
+	mSamples.push_back( Sample );
+
+	mBackend = Backend;
+	mChoice = Choice;
+	mNonzeros = Features.Nonzeros;
+
+	mNumDisp = Backend->mNumDisp;
+	mNumYEdges = Backend->mNumYEdges;
+	mNumDOF = Backend->mNumDOF;
+	mIterationAlgorithm = Backend->mIterationAlgorithm;
+
+	fGetColumnSolution();
+
+	return Result;
+}
+
+void
+CAutoDLOSolver::fGetColumnSolution()
+{
+	size_t Size = 0;
+	double* Array = mBackend ? mBackend->GetResultArray( Size ) : nullptr;
+
+	fResizeResult( Array ? Size : 0 );
+
+	if ( mSize )
+		memcpy( mResultArray, Array, sizeof( double ) * mSize );
+}
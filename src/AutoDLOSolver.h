@@ -0,0 +1,51 @@
+// AutoDLOSolver.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include "DLOSolver.h"
+#include "CoinDLOSolver.h"
+#ifdef DLO_WITH_HIGHS
+#include "HighsDLOSolver.h"
+#endif
+#include "LPSelector.h"
+
+// Picks the backend and LP algorithm for every column generation iteration
+// from the cost model of its selector.  The timings of the iterations are
+// kept as samples so that the selector can be calibrated from benchmark runs.
+class CAutoDLOSolver : public CDLOSolver
+{
+public:
+	CAutoDLOSolver();
+
+	virtual ~CAutoDLOSolver() {};
+
+	double Solve( CDomain* Domain ) override;
+
+	CLPSelector& GetSelector() { return mSelector; };
+	const std::vector<sLPSample>& GetSamples() { return mSamples; };
+
+	CCoinDLOSolver& GetCoinSolver() { return mCoin; };
+#ifdef DLO_WITH_HIGHS
+	CHighsDLOSolver& GetHighsSolver() { return mHighs; };
+#endif
+
+protected:
+	CLPSelector mSelector;
+	CCoinDLOSolver mCoin;
+#ifdef DLO_WITH_HIGHS
+	CHighsDLOSolver mHighs;
+#endif
+
+	CDLOSolver* mBackend;
+	sLPChoice mChoice;
+	size_t mNonzeros;
+
+	std::vector<sLPSample> mSamples;
+
+	double* fSolve( double& Objective ) override;
+	void fGetColumnSolution() override;
+
+	sLPFeatures fGetFeatures();
+};
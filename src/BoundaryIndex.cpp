@@ -0,0 +1,342 @@
+// BoundaryIndex.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "BoundaryIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const double kTolerance = 1e-9;
+
+CBoundaryIndex::CBoundaryIndex():
+	mConvex( true ),
+	mCellSize( 1 ),
+	mColumns( 1 ),
+	mRows( 1 )
+{
+}
+
+void
+CBoundaryIndex::fAddPolygon( const std::vector<CPoint2D>& Points,
+							 bool Closed )
+{
+	for ( size_t i = 0; i < Points.size(); ++i )
+		mSegments.push_back( { Points[i], Points[(i + 1) % Points.size()], Closed } );
+}
+
+void
+CBoundaryIndex::Build( const CPoly2D& Outline,
+					   const std::vector<CPoly2D>& Openings,
+					   const std::vector<CLine2D>& Supports )
+{
+	mSegments.clear();
+	mCellStart.clear();
+	mCellSegments.clear();
+
+	mOutline = Outline;
+	mOpenings = Openings;
+
+	std::vector<CPoint2D> Points;
+	for ( size_t i = 0; i < Outline.GetNumPoints(); ++i )
+		Points.push_back( Outline.GetPoint( i ) );
+
+	fAddPolygon( Points, true );
+
+	for ( const auto& Opening : Openings )
+	{
+		Points.clear();
+		for ( size_t i = 0; i < Opening.GetNumPoints(); ++i )
+			Points.push_back( Opening.GetPoint( i ) );
+
+		fAddPolygon( Points, true );
+	}
+
+	for ( const auto& Support : Supports )
+		mSegments.push_back( { Support.P1(), Support.P2(), false } );
+
+	mConvex = Openings.empty() && Supports.empty() && Outline.IsConvex();
+
+	if ( mConvex || mSegments.empty() )
+		return;
+
+	CPoint2D Max = mSegments[0].P1;
+	mMin = Max;
+
+	for ( const auto& Segment : mSegments )
+	{
+		mMin.x = std::min( { mMin.x, Segment.P1.x, Segment.P2.x } );
+		mMin.y = std::min( { mMin.y, Segment.P1.y, Segment.P2.y } );
+		Max.x = std::max( { Max.x, Segment.P1.x, Segment.P2.x } );
+		Max.y = std::max( { Max.y, Segment.P1.y, Segment.P2.y } );
+	}
+
+	// About one segment per cell
+	double Width = std::max( Max.x - mMin.x, kTolerance );
+	double Height = std::max( Max.y - mMin.y, kTolerance );
+	double Side = std::ceil( std::sqrt( static_cast<double>(mSegments.size()) ) );
+
+	mCellSize = std::max( Width, Height ) / Side;
+	mColumns = std::max<size_t>( static_cast<size_t>(std::ceil( Width / mCellSize )), 1 );
+	mRows = std::max<size_t>( static_cast<size_t>(std::ceil( Height / mCellSize )), 1 );
+
+	// Count, then fill
+	mCellStart.assign( mColumns * mRows + 1, 0 );
+
+	for ( int Pass = 0; Pass < 2; ++Pass )
+	{
+		std::vector<size_t> Next( mCellStart.begin(), mCellStart.end() - 1 );
+
+		if ( Pass == 1 )
+			mCellSegments.resize( mCellStart.back() );
+
+		for ( size_t i = 0; i < mSegments.size(); ++i )
+		{
+			const sSegment& Segment = mSegments[i];
+
+			size_t c0 = fColumn( std::min( Segment.P1.x, Segment.P2.x ) - kTolerance );
+			size_t c1 = fColumn( std::max( Segment.P1.x, Segment.P2.x ) + kTolerance );
+			size_t r0 = fRow( std::min( Segment.P1.y, Segment.P2.y ) - kTolerance );
+			size_t r1 = fRow( std::max( Segment.P1.y, Segment.P2.y ) + kTolerance );
+
+			for ( size_t r = r0; r <= r1; ++r )
+			{
+				for ( size_t c = c0; c <= c1; ++c )
+				{
+					if ( !fOverlaps( Segment, c, r ) )
+						continue;
+
+					size_t Cell = r * mColumns + c;
+
+					if ( Pass == 0 )
+						++mCellStart[Cell + 1];
+					else
+						mCellSegments[Next[Cell]++] = static_cast<uint32_t>(i);
+				}
+			}
+		}
+
+		if ( Pass == 0 )
+		{
+			for ( size_t i = 1; i < mCellStart.size(); ++i )
+				mCellStart[i] += mCellStart[i - 1];
+		}
+	}
+}
+
+size_t
+CBoundaryIndex::fColumn( double x ) const
+{
+	double c = std::floor( (x - mMin.x) / mCellSize );
+
+	return static_cast<size_t>(std::min( std::max( c, 0.0 ), static_cast<double>(mColumns - 1) ));
+}
+
+size_t
+CBoundaryIndex::fRow( double y ) const
+{
+	double r = std::floor( (y - mMin.y) / mCellSize );
+
+	return static_cast<size_t>(std::min( std::max( r, 0.0 ), static_cast<double>(mRows - 1) ));
+}
+
+bool
+CBoundaryIndex::fOverlaps( const sSegment& Segment,
+						   size_t Column,
+						   size_t Row ) const
+{
+	// Clip the segment against the cell grown by the tolerance, so a segment
+	// on a cell border is found from both sides
+	double x0 = mMin.x + Column * mCellSize - kTolerance;
+	double x1 = x0 + mCellSize + 2 * kTolerance;
+	double y0 = mMin.y + Row * mCellSize - kTolerance;
+	double y1 = y0 + mCellSize + 2 * kTolerance;
+
+	double dx = Segment.P2.x - Segment.P1.x;
+	double dy = Segment.P2.y - Segment.P1.y;
+
+	double t0 = 0, t1 = 1;
+
+	auto Clip = [&]( double p, double q ) -> bool
+	{
+		if ( std::abs( p ) < 1e-300 )
+			return q >= 0;
+
+		double t = q / p;
+
+		if ( p < 0 )
+			t0 = std::max( t0, t );
+		else
+			t1 = std::min( t1, t );
+
+		return t0 <= t1;
+	};
+
+	return Clip( -dx, Segment.P1.x - x0 ) &&
+		Clip( dx, x1 - Segment.P1.x ) &&
+		Clip( -dy, Segment.P1.y - y0 ) &&
+		Clip( dy, y1 - Segment.P1.y );
+}
+
+bool
+CBoundaryIndex::fCrosses( const sSegment& Segment,
+						  const CPoint2D& P1,
+						  const CPoint2D& P2 ) const
+{
+	// Signed distance of p from the line through a and b
+	auto Side = []( const CPoint2D& a, const CPoint2D& b, const CPoint2D& p ) -> double
+	{
+		double dx = b.x - a.x;
+		double dy = b.y - a.y;
+		double Length = std::sqrt( dx * dx + dy * dy );
+
+		return Length > 0 ? (dx * (p.y - a.y) - dy * (p.x - a.x)) / Length : 0;
+	};
+
+	auto Apart = []( double a, double b ) -> bool
+	{
+		return (a > kTolerance && b < -kTolerance) || (a < -kTolerance && b > kTolerance);
+	};
+
+	// Touching at a node is allowed, only a proper crossing leaves the plate
+	return Apart( Side( Segment.P1, Segment.P2, P1 ), Side( Segment.P1, Segment.P2, P2 ) ) &&
+		Apart( Side( P1, P2, Segment.P1 ), Side( P1, P2, Segment.P2 ) );
+}
+
+bool
+CBoundaryIndex::fContains( const CPoint2D& Point ) const
+{
+	// Crossings of a ray in +x with the outline and openings.  A segment is
+	// counted in the cell that holds its crossing, once.
+	size_t Row = fRow( Point.y );
+	size_t Crossings = 0;
+
+	for ( size_t c = fColumn( Point.x ); c < mColumns; ++c )
+	{
+		size_t Cell = Row * mColumns + c;
+
+		for ( size_t k = mCellStart[Cell]; k < mCellStart[Cell + 1]; ++k )
+		{
+			const sSegment& Segment = mSegments[mCellSegments[k]];
+
+			if ( !Segment.Closed || (Segment.P1.y > Point.y) == (Segment.P2.y > Point.y) )
+				continue;
+
+			double x = Segment.P1.x + (Point.y - Segment.P1.y) * (Segment.P2.x - Segment.P1.x) / (Segment.P2.y - Segment.P1.y);
+
+			if ( x > Point.x && fColumn( x ) == c )
+				++Crossings;
+		}
+	}
+
+	return Crossings % 2 == 1;
+}
+
+bool
+CBoundaryIndex::IsInside( const CPoint2D& P1,
+						  const CPoint2D& P2 ) const
+{
+	if ( mConvex )
+		return true;
+
+	return !fCrossesAny( P1, P2 ) && fContains( (P1 + P2) / 2 );
+}
+
+void
+CBoundaryIndex::IsInside( const CPoint2D& P1,
+						  const double* x,
+						  const double* y,
+						  size_t Count,
+						  double* Mid,
+						  uint64_t* Mask ) const
+{
+	size_t Words = CPoly2D::MaskWords( Count );
+
+	if ( mConvex )
+	{
+		std::fill( Mask, Mask + Words, ~uint64_t( 0 ) );
+		if ( Count % 64 )
+			Mask[Words - 1] = (uint64_t( 1 ) << (Count % 64)) - 1;
+
+		return;
+	}
+
+	double* mx = Mid;
+	double* my = Mid + Count;
+
+	for ( size_t i = 0; i < Count; ++i )
+	{
+		mx[i] = (P1.x + x[i]) / 2;
+		my[i] = (P1.y + y[i]) / 2;
+	}
+
+	mOutline.PointsInPoly( mx, my, Count, Mask );
+
+	// A word of points at a time against each opening
+	for ( size_t w = 0; w < Words; ++w )
+	{
+		size_t n = std::min<size_t>( Count - w * 64, 64 );
+
+		for ( const auto& Opening : mOpenings )
+		{
+			uint64_t Hole;
+			Opening.PointsInPoly( mx + w * 64, my + w * 64, n, &Hole );
+			Mask[w] &= ~Hole;
+		}
+
+		for ( size_t b = 0; b < n; ++b )
+		{
+			size_t i = w * 64 + b;
+
+			if ( (Mask[w] >> b & 1) && fCrossesAny( P1, CPoint2D( x[i], y[i] ) ) )
+				Mask[w] &= ~(uint64_t( 1 ) << (i % 64));
+		}
+	}
+}
+
+bool
+CBoundaryIndex::fCrossesAny( const CPoint2D& P1,
+							 const CPoint2D& P2 ) const
+{
+	// Cells along the edge, row by row: the x range of the edge within the
+	// band of the row, grown by the tolerance
+	double dx = P2.x - P1.x;
+	double dy = P2.y - P1.y;
+
+	size_t r0 = fRow( std::min( P1.y, P2.y ) - kTolerance );
+	size_t r1 = fRow( std::max( P1.y, P2.y ) + kTolerance );
+
+	for ( size_t r = r0; r <= r1; ++r )
+	{
+		double xMin = std::min( P1.x, P2.x );
+		double xMax = std::max( P1.x, P2.x );
+
+		if ( std::abs( dy ) > kTolerance )
+		{
+			double y0 = std::max( mMin.y + r * mCellSize, std::min( P1.y, P2.y ) );
+			double y1 = std::min( mMin.y + (r + 1) * mCellSize, std::max( P1.y, P2.y ) );
+
+			double xa = P1.x + (y0 - P1.y) * dx / dy;
+			double xb = P1.x + (y1 - P1.y) * dx / dy;
+
+			xMin = std::max( xMin, std::min( xa, xb ) );
+			xMax = std::min( xMax, std::max( xa, xb ) );
+		}
+
+		size_t c0 = fColumn( xMin - kTolerance );
+		size_t c1 = fColumn( xMax + kTolerance );
+
+		for ( size_t c = c0; c <= c1; ++c )
+		{
+			size_t Cell = r * mColumns + c;
+
+			for ( size_t k = mCellStart[Cell]; k < mCellStart[Cell + 1]; ++k )
+			{
+				if ( fCrosses( mSegments[mCellSegments[k]], P1, P2 ) )
+					return true;
+			}
+		}
+	}
+
+	return false;
+}
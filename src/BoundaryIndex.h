@@ -0,0 +1,83 @@
+// BoundaryIndex.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include "Point2D.h"
+#include "Line2D.h"
+#include "Poly2D.h"
+
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over the segments of the outline, the openings and the
+// internal supports, answers whether a candidate edge between two nodes
+// stays inside the plate by visiting only the cells along the edge.  A
+// convex outline without openings or supports needs no test at all.
+class CBoundaryIndex
+{
+public:
+	CBoundaryIndex();
+	virtual ~CBoundaryIndex() {};
+
+	void Build( const CPoly2D& Outline,
+				const std::vector<CPoly2D>& Openings,
+				const std::vector<CLine2D>& Supports );
+
+	// The edge may not cross a segment and its midpoint has to lie inside
+	// the outline and outside every opening.  Safe to call concurrently.
+	bool IsInside( const CPoint2D& P1,
+				   const CPoint2D& P2 ) const;
+
+	// Batch over the edges from P1 to (x[i], y[i]), the midpoints are
+	// classified against the outline and openings together.  Sets the bits
+	// of Mask (see CPoly2D::MaskWords) of the edges inside, Mid is scratch
+	// for 2 * Count doubles.
+	void IsInside( const CPoint2D& P1,
+				   const double* x,
+				   const double* y,
+				   size_t Count,
+				   double* Mid,
+				   uint64_t* Mask ) const;
+
+	bool IsConvex() const { return mConvex; };
+
+protected:
+	struct sSegment
+	{
+		CPoint2D P1, P2;
+
+		// Outline and opening segments bound the plate, supports do not
+		bool Closed;
+	};
+
+	std::vector<sSegment> mSegments;
+	bool mConvex;
+
+	CPoly2D mOutline;
+	std::vector<CPoly2D> mOpenings;
+
+	CPoint2D mMin;
+	double mCellSize;
+	size_t mColumns;
+	size_t mRows;
+
+	// Segments of each cell, cell c owns [mCellStart[c], mCellStart[c + 1])
+	std::vector<size_t> mCellStart;
+	std::vector<uint32_t> mCellSegments;
+
+	void fAddPolygon( const std::vector<CPoint2D>& Points,
+					  bool Closed );
+	bool fOverlaps( const sSegment& Segment,
+					size_t Column,
+					size_t Row ) const;
+	bool fCrosses( const sSegment& Segment,
+				   const CPoint2D& P1,
+				   const CPoint2D& P2 ) const;
+	bool fCrossesAny( const CPoint2D& P1,
+					  const CPoint2D& P2 ) const;
+	bool fContains( const CPoint2D& Point ) const;
+	size_t fColumn( double x ) const;
+	size_t fRow( double y ) const;
+};
@@ -0,0 +1,288 @@
+// CandidatePool.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "CandidatePool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Mapping offsets are multiples of the Windows allocation granularity, which
+// is also a multiple of the page size
+static const size_t kGranularity = 65536;
+static const size_t kPage = 4096;
+
+CCandidatePool::CCandidatePool():
+	mBudget( 0 ),
+	mWindow( 0 ),
+	mSize( 0 ),
+	mLoadWidth( 0 ),
+	mIOTime( 0 ),
+	mOpen( false )
+{
+}
+
+CCandidatePool::~CCandidatePool()
+{
+	Close();
+}
+
+size_t
+CCandidatePool::GetMinimumBudget()
+{
+	return kGranularity;
+}
+
+bool
+CCandidatePool::Open( const std::string& File,
+					  size_t Budget,
+					  size_t LoadWidth )
+{
+	Close();
+
+	mBudget = Budget;
+	mSize = 0;
+	mLoadWidth = LoadWidth;
+	mIOTime = 0;
+
+	// A window of records and their load factors is the whole budget,
+	// rounded down to whole mapping granules
+	size_t RecordBytes = sizeof( sCandidateEdge ) + mLoadWidth * sizeof( float );
+	mWindow = std::max( Budget - Budget % kGranularity, kGranularity ) / RecordBytes;
+
+	mOpen = fOpen( mRecords, File );
+
+	if ( mOpen && mLoadWidth )
+	{
+		mOpen = fOpen( mLoads, File + ".loads" );
+		if ( !mOpen )
+			fClose( mRecords );
+	}
+
+	return mOpen;
+}
+
+bool
+CCandidatePool::Append( const std::vector<sCandidateEdge>& Records,
+						const std::vector<float>& Loads )
+{
+	if ( !mOpen || Records.empty() )
+		return mOpen;
+
+	if ( Loads.size() != Records.size() * mLoadWidth )
+		return false;
+
+	auto Start = std::chrono::steady_clock::now();
+
+	bool Result = fWrite( mRecords, reinterpret_cast<const char*>(&Records[0]), Records.size() * sizeof( sCandidateEdge ) );
+
+	if ( Result && mLoadWidth )
+		Result = fWrite( mLoads, reinterpret_cast<const char*>(&Loads[0]), Loads.size() * sizeof( float ) );
+
+	if ( Result )
+		mSize += Records.size();
+
+	std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+	mIOTime += Elapsed.count();
+
+	return Result;
+}
+
+void
+CCandidatePool::Close()
+{
+	if ( !mOpen )
+		return;
+
+	fClose( mRecords );
+	if ( mLoadWidth )
+		fClose( mLoads );
+
+	mOpen = false;
+	mSize = 0;
+}
+
+bool
+CCandidatePool::ForEach( const tVisitor& Visit )
+{
+	for ( size_t First = 0; First < mSize; First += mWindow )
+	{
+		size_t Count = std::min( mWindow, mSize - First );
+		size_t RecordBytes = Count * sizeof( sCandidateEdge );
+		size_t LoadBytes = Count * mLoadWidth * sizeof( float );
+
+		auto Start = std::chrono::steady_clock::now();
+
+		const char* Records = fMap( mRecords, First * sizeof( sCandidateEdge ), RecordBytes );
+		if ( !Records )
+			return false;
+
+		const char* Loads = nullptr;
+		if ( mLoadWidth )
+		{
+			Loads = fMap( mLoads, First * mLoadWidth * sizeof( float ), LoadBytes );
+			if ( !Loads )
+			{
+				fUnmap( Records, First * sizeof( sCandidateEdge ), RecordBytes );
+				return false;
+			}
+		}
+
+		// Fault the window in up front, so the pricing time excludes the I/O
+		volatile char Touch = 0;
+		for ( size_t i = 0; i < RecordBytes; i += kPage )
+			Touch += Records[i];
+		for ( size_t i = 0; i < LoadBytes; i += kPage )
+			Touch += Loads[i];
+
+		std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+		mIOTime += Elapsed.count();
+
+		Visit( reinterpret_cast<const sCandidateEdge*>(Records), reinterpret_cast<const float*>(Loads), Count, First );
+
+		fUnmap( Records, First * sizeof( sCandidateEdge ), RecordBytes );
+		if ( Loads )
+			fUnmap( Loads, First * mLoadWidth * sizeof( float ), LoadBytes );
+	}
+
+	return true;
+}
+
+bool
+CCandidatePool::fOpen( sFile& File,
+					   const std::string& Path )
+{
+	File.Path = Path;
+
+#ifdef _WIN32
+	File.Mapping = nullptr;
+	File.Handle = CreateFileA( Path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+							   FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr );
+	return File.Handle != INVALID_HANDLE_VALUE;
+#else
+	File.Handle = open( Path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+	return File.Handle != -1;
+#endif
+}
+
+bool
+CCandidatePool::fWrite( sFile& File,
+						const char* Data,
+						size_t Bytes )
+{
+	bool Result = true;
+
+#ifdef _WIN32
+	// The mapping object has a fixed size, it is recreated after appending
+	if ( File.Mapping )
+	{
+		CloseHandle( File.Mapping );
+		File.Mapping = nullptr;
+	}
+
+	while ( Bytes && Result )
+	{
+		DWORD Written = 0;
+		DWORD Chunk = static_cast<DWORD>(std::min<size_t>( Bytes, 1 << 30 ));
+
+		Result = WriteFile( File.Handle, Data, Chunk, &Written, nullptr ) && Written;
+		Data += Written;
+		Bytes -= Written;
+	}
+#else
+	while ( Bytes && Result )
+	{
+		ssize_t Written = write( File.Handle, Data, Bytes );
+
+		Result = Written > 0;
+		if ( Result )
+		{
+			Data += Written;
+			Bytes -= Written;
+		}
+	}
+#endif
+
+	return Result;
+}
+
+void
+CCandidatePool::fClose( sFile& File )
+{
+#ifdef _WIN32
+	if ( File.Mapping )
+		CloseHandle( File.Mapping );
+	CloseHandle( File.Handle );
+
+	File.Mapping = nullptr;
+	File.Handle = INVALID_HANDLE_VALUE;
+#else
+	close( File.Handle );
+	std::remove( File.Path.c_str() );
+
+	File.Handle = -1;
+#endif
+}
+
+const char*
+CCandidatePool::fMap( sFile& File,
+					  size_t Offset,
+					  size_t Bytes )
+{
+	size_t Base = Offset - Offset % kGranularity;
+	size_t Length = Offset + Bytes - Base;
+
+	const char* View = nullptr;
+
+#ifdef _WIN32
+	if ( !File.Mapping )
+		File.Mapping = CreateFileMappingA( File.Handle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+	if ( File.Mapping )
+		View = static_cast<const char*>(MapViewOfFile( File.Mapping, FILE_MAP_READ,
+													   static_cast<DWORD>(static_cast<uint64_t>(Base) >> 32),
+													   static_cast<DWORD>(Base & 0xffffffff),
+													   Length ));
+#else
+	void* Mapped = mmap( nullptr, Length, PROT_READ, MAP_SHARED, File.Handle, static_cast<off_t>(Base) );
+
+	if ( Mapped != MAP_FAILED )
+	{
+		madvise( Mapped, Length, MADV_SEQUENTIAL );
+		View = static_cast<const char*>(Mapped);
+	}
+#endif
+
+	if ( !View )
+		return nullptr;
+
+	return View + (Offset - Base);
+}
+
+void
+CCandidatePool::fUnmap( const char* Data,
+						size_t Offset,
+						size_t Bytes )
+{
+	size_t Base = Offset - Offset % kGranularity;
+	size_t Length = Offset + Bytes - Base;
+
+	const char* View = Data - (Offset - Base);
+
+#ifdef _WIN32
+	UnmapViewOfFile( View );
+#else
+	munmap( const_cast<char*>(View), Length );
+#endif
+}
@@ -0,0 +1,80 @@
+// CandidatePool.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include "Edge.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// File backed store of compact candidate edges for meshes whose candidate
+// set does not fit in memory.  BuildEdges appends the records in blocks,
+// pricing maps them back one window of at most the memory budget at a time.
+// The load factors of every record, if any, are kept in a second file.
+class CCandidatePool
+{
+public:
+	// Loads holds LoadWidth factors per record, nullptr without loads
+	typedef std::function<void( const sCandidateEdge* Records, const float* Loads, size_t Count, size_t First )> tVisitor;
+
+	CCandidatePool();
+	virtual ~CCandidatePool();
+
+	bool Open( const std::string& File,
+			   size_t Budget,
+			   size_t LoadWidth );
+	bool Append( const std::vector<sCandidateEdge>& Records,
+				 const std::vector<float>& Loads );
+	void Close();
+
+	// Visits the records in file order, one mapped window per call
+	bool ForEach( const tVisitor& Visit );
+
+	bool IsOpen() { return mOpen; };
+	size_t Size() { return mSize; };
+	size_t GetBudget() { return mBudget; };
+	size_t GetLoadWidth() { return mLoadWidth; };
+
+	// A budget holds at least one mapping window
+	static size_t GetMinimumBudget();
+
+	// Time spent writing, mapping and faulting in windows
+	double GetIOTime() { return mIOTime; };
+
+protected:
+	struct sFile
+	{
+		std::string Path;
+#ifdef _WIN32
+		void* Handle;
+		void* Mapping;
+#else
+		int Handle;
+#endif
+	};
+
+	sFile mRecords;
+	sFile mLoads;
+	size_t mBudget;
+	size_t mWindow;
+	size_t mSize;
+	size_t mLoadWidth;
+	double mIOTime;
+	bool mOpen;
+
+	bool fOpen( sFile& File,
+				const std::string& Path );
+	bool fWrite( sFile& File,
+				 const char* Data,
+				 size_t Bytes );
+	void fClose( sFile& File );
+	const char* fMap( sFile& File,
+					  size_t Offset,
+					  size_t Bytes );
+	void fUnmap( const char* Data,
+				 size_t Offset,
+				 size_t Bytes );
+};
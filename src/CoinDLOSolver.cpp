@@ -6,27 +6,195 @@
 
 #include "Constants.h"
 #include "Domain.h"
+
+#include "ClpSimplex.hpp"
+#include "ClpEventHandler.hpp"
+#include "ClpCholeskyBase.hpp"
+#include "ClpCholeskyDense.hpp"
+#ifdef DLO_CLP_UFL
+#include "ClpCholeskyUfl.hpp"
+#endif
+#ifdef PARDISO_BARRIER
 #include "ClpCholeskyPardiso.hpp"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+// Stops the solver it is passed to at the end of its next iteration once
+// the other solver of a concurrent race has found an optimal solution.
+class CCancelHandler : public ClpEventHandler
+{
+public:
+	CCancelHandler( const std::atomic<bool>* Stop ):
+		mStop( Stop )
+	{
+	};
+
+	int event( Event whichEvent ) override
+	{
+		if ( whichEvent == endOfIteration && mStop->load() )
+			return 0;
+
+		return -1;
+	};
+
+	ClpEventHandler* clone() const override { return new CCancelHandler( *this ); };
+
+private:
+	const std::atomic<bool>* mStop;
+};
+
+CCoinDLOSolver::CCoinDLOSolver():
+	mModel( nullptr ),
+	mStopSimplex( false ),
+	mStopBarrier( false ),
+#ifdef PARDISO_BARRIER
+	mCholesky( eCholeskyType::PARDISO ),
+#else
+	mCholesky( eCholeskyType::NATIVE ),
+#endif
+	mAlgorithm( eLPAlgorithm::BARRIER ),
+	mFormulation( eDLOFormulation::KINEMATIC ),
+	mEquilibrium( nullptr )
+{
+}
 
 CCoinDLOSolver::~CCoinDLOSolver()
 {
-	delete mModel;
+	delete mSimplex;
+	delete mBarrier;
+	delete mEquilibrium;
+}
+
+double
+CCoinDLOSolver::Solve( CDomain* Domain )
+{
+	fResetModel();
+
+	return CDLOSolver::Solve( Domain );
 }
 
 void
-CCoinDLOSolver::fGetColumnSolution()
+CCoinDLOSolver::fResetModel()
 {
-	if (mResultArray)
+	delete mEquilibrium;
+	mEquilibrium = nullptr;
+
+	mModelEdges.clear();
+	mModelIndex.clear();
+}
+
+bool
+CCoinDLOSolver::fInModel( const CEdge* Edge )
+{
+	return Edge->Position < mModelIndex.size() && mModelIndex[Edge->Position] != kNotInModel;
+}
+
+void
+CCoinDLOSolver::fSetModelIndex( const CEdge* Edge,
+								size_t Index )
+{
+	// Edges materialized during the solve are numbered after the others
+	if ( Edge->Position >= mModelIndex.size() )
+		mModelIndex.resize( Edge->Position + 1, kNotInModel );
+
+	mModelIndex[Edge->Position] = Index;
+}
+
+void
+CCoinDLOSolver::fReserveModel()
+{
+	// Upper bounds as in fReserveIteration, a no-op once the buffers have
+	// been sized for the domain
+	size_t Edges = mDomain->mEdges.size();
+	size_t NodeRows = mDomain->mNodes.size() * 3;
+
+	if ( mFormulation == eDLOFormulation::EQUILIBRIUM )
 	{
-		delete[]mResultArray;
-		mResultArray = nullptr;
+		size_t Entries = 3 * Edges * (CEdgeAssembly::kMaxEntries + 1);
+
+		mRowBound.reserve( 3 * Edges );
+		mRowStart.reserve( 3 * Edges + 1 );
+		mIndex.reserve( Entries );
+		mValue.reserve( Entries );
+		mLower.reserve( Edges );
+		mUpper.reserve( Edges );
+		mCost.reserve( Edges );
+		mColumnStart.reserve( Edges + 1 );
+		mColumnIndex.reserve( Edges );
+		mColumnValue.reserve( Edges );
+		mRemovedRows.reserve( 3 * Edges );
+		mRemovedColumns.reserve( Edges );
+		mRowShift.reserve( 3 * Edges + 1 );
+		mColumnShift.reserve( NodeRows + Edges + 2 );
+		mModelEdges.reserve( Edges );
+		mKeptEdges.reserve( Edges );
 	}
+	else
+	{
+		mLower.reserve( 5 * Edges );
+		mUpper.reserve( 5 * Edges );
+		mCost.reserve( 5 * Edges );
+		mRowBound.reserve( NodeRows + Edges + 1 );
+	}
+}
 
-	mResultArray = new double[mNumDisp + mNumYEdges * 2];
+bool
+CCoinDLOSolver::IsCholeskyAvailable( eCholeskyType Type )
+{
+	switch ( Type )
+	{
+	case eCholeskyType::NATIVE:
+	case eCholeskyType::DENSE:
+		return true;
+#ifdef DLO_CLP_UFL
+	case eCholeskyType::UFL:
+		return true;
+#endif
+#ifdef PARDISO_BARRIER
+	case eCholeskyType::PARDISO:
+		return true;
+#endif
+	default:
+		break;
+	}
 
-	mSize = mNumDisp + mNumYEdges * 2;
+	return false;
+}
 
-	if (mResultArray)
+ClpCholeskyBase*
+CCoinDLOSolver::fCreateCholesky()
+{
+	switch ( mCholesky )
+	{
+	case eCholeskyType::DENSE:
+		return new ClpCholeskyDense();
+#ifdef DLO_CLP_UFL
+	case eCholeskyType::UFL:
+		return new ClpCholeskyUfl();
+#endif
+#ifdef PARDISO_BARRIER
+	case eCholeskyType::PARDISO:
+		return new ClpCholeskyPardiso();
+#endif
+	default:
+		break;
+	}
+
+	return new ClpCholeskyBase();
+}
+
+void
+CCoinDLOSolver::fGetColumnSolution()
+{
+	fResizeResult( mNumDisp + mNumYEdges * 2 );
+
+	if (mFormulation == eDLOFormulation::EQUILIBRIUM)
+		fGetEquilibriumSolution();
+	else if (mResultArray)
 	{
 		memcpy( mResultArray, mModel->getColSolution(), sizeof( double ) * mSize );
 	}
@@ -35,6 +203,11 @@ CCoinDLOSolver::fGetColumnSolution()
 double*
 CCoinDLOSolver::fSolve( double& Objective )
 {
+	fReserveModel();
+
+	if (mFormulation == eDLOFormulation::EQUILIBRIUM)
+		return fSolveEquilibrium( Objective );
+
 	double* Result = nullptr;
 
 	mNumDisp = fGetEdgeVarCount();
@@ -48,58 +221,36 @@ CCoinDLOSolver::fSolve( double& Objective )
 	mfD.clear();
 
 	mfD.resize( mNumDOF, 0.0 );
-	mDomain->fCalculateUDL( mfD, mDomain->mDeadLoad );
-
 	mfL.resize( mNumDOF, 0.0 );
-	mDomain->fCalculateUDL( mfL, mDomain->mLiveLoad );
+	mDomain->fCalculateLoads( mActiveEdges, mfL, mfD );
 
-	mPtrb.resize( numvar, -1 );
+	// mPtrb holds the column starts, one more than there are columns
+	mPtrb.resize( numvar + 1, -1 );
 	mPtre.resize( numvar, -1 );
 	mSub.clear();
 	mVal.clear();
 
-	mModel = new ClpInterior();
-	ClpCholeskyPardiso* cholesky = new ClpCholeskyPardiso();
-	static_cast<ClpInterior*>(mModel)->setCholesky( cholesky );
-	mModel->setPrimalTolerance( 1e-8 );
-	mModel->setDualTolerance( 1e-8 );
-	mModel->setLogLevel( 0 );
-	mModel->resize( static_cast<int>(numcon), 0 );
-
-	int Row = 0;
-
 	fCalculateCompatibilityMatrix();
 	fCalculatePlasticMultiplierTerms();
 
-	size_t dsz = mfD.size();
-	size_t psz = mObjP.size();
+	mPtrb[numvar] = static_cast<int>(mVal.size());
 
-	for (size_t i = 0; i < dsz; ++i)
-	{
-		mModel->setObjectiveCoefficient( Row, mfD[i] );
-		mModel->setColumnLower( Row, -COIN_DBL_MAX );
-		mModel->setColumnUpper( Row, COIN_DBL_MAX );
-		++Row;
-	}
+	// Free displacements followed by the plastic multipliers
+	mCost.assign( mfD.begin(), mfD.end() );
+	mCost.insert( mCost.end(), mObjP.begin(), mObjP.end() );
 
-	for (size_t i = 0; i < psz; ++i)
-	{
-		mModel->setObjectiveCoefficient( Row, mObjP[i] );
-		mModel->setColumnLower( Row, 0.0 );
-		mModel->setColumnUpper( Row, COIN_DBL_MAX );
-		++Row;
-	}
+	mLower.assign( mfD.size(), -COIN_DBL_MAX );
+	mLower.resize( mCost.size(), 0.0 );
+	mUpper.assign( mCost.size(), COIN_DBL_MAX );
 
-	for (size_t i = 0; i < numcon - 1; ++i)
-		mModel->setRowBounds( static_cast<int>(i), 0, 0 );
+	mRowBound.assign( numcon, 0.0 );
+	mRowBound[numcon - 1] = 1.0;
 
-	mModel->setRowBounds( static_cast<int>(numcon) - 1, 1, 1 );
-
-	static_cast<ClpInterior*>(mModel)->primalDual();
+	fRunAlgorithm( static_cast<int>(mCost.size()), static_cast<int>(numcon) );
 
 	Objective = mModel->objectiveValue();
 
-	Result = new double[numcon];
+	Result = mArena.Allocate<double>( numcon );
 	if (Result)
 	{
 
@@ -112,6 +263,123 @@ CCoinDLOSolver::fSolve( double& Objective )
 	return Result;
 }
 
+template<class tSolver>
+void
+CCoinDLOSolver::fLoadProblem( tSolver* Solver,
+							  int Columns,
+							  int Rows )
+{
+	Solver->loadProblem( Columns, Rows, &mPtrb[0], &mSub[0], &mVal[0],
+						 &mLower[0], &mUpper[0], &mCost[0],
+						 &mRowBound[0], &mRowBound[0] );
+
+	Solver->setPrimalTolerance( mTolerance );
+	Solver->setDualTolerance( mTolerance );
+}
+
+void
+CCoinDLOSolver::fRunAlgorithm( int Columns,
+							   int Rows )
+{
+	// The solvers are created on the first LP, Clp keeps a clone of the
+	// cancel handlers.  Clp has no first order method, FIRST_ORDER runs the
+	// barrier.
+	if ( !mSimplex )
+	{
+		CCancelHandler Handler( &mStopSimplex );
+
+		mSimplex = new ClpSimplex();
+		mSimplex->setLogLevel( 0 );
+		mSimplex->passInEventHandler( &Handler );
+	}
+
+	if ( !mBarrier )
+	{
+		CCancelHandler Handler( &mStopBarrier );
+
+		mBarrier = new ClpInterior();
+		mBarrier->setLogLevel( 0 );
+		mBarrier->passInEventHandler( &Handler );
+	}
+
+	switch ( mAlgorithm )
+	{
+	case eLPAlgorithm::CONCURRENT:
+		fRunConcurrent( Columns, Rows );
+		break;
+	case eLPAlgorithm::DUAL_SIMPLEX:
+	case eLPAlgorithm::PRIMAL_SIMPLEX:
+		fLoadProblem( mSimplex, Columns, Rows );
+
+		if ( mAlgorithm == eLPAlgorithm::DUAL_SIMPLEX )
+			mSimplex->dual();
+		else
+			mSimplex->primal();
+
+		mModel = mSimplex;
+		mIterationAlgorithm = mAlgorithm;
+		break;
+	default:
+		fLoadProblem( mBarrier, Columns, Rows );
+		mBarrier->setCholesky( fCreateCholesky() );
+		mBarrier->primalDual();
+
+		mModel = mBarrier;
+		mIterationAlgorithm = eLPAlgorithm::BARRIER;
+		break;
+	}
+}
+
+void
+CCoinDLOSolver::fRunConcurrent( int Columns,
+								int Rows )
+{
+	fLoadProblem( mBarrier, Columns, Rows );
+	fLoadProblem( mSimplex, Columns, Rows );
+
+	mBarrier->setCholesky( fCreateCholesky() );
+
+	// Each side only reads its own flag, the winner sets the flag of the
+	// other one and both stop at the end of their next iteration
+	mStopSimplex = false;
+	mStopBarrier = false;
+	std::atomic<int> Winner( -1 );
+
+	std::thread BarrierThread( [&]()
+	{
+		mBarrier->primalDual();
+
+		int None = -1;
+		if ( mBarrier->isProvenOptimal() &&
+			 Winner.compare_exchange_strong( None, static_cast<int>(eLPAlgorithm::BARRIER) ) )
+			mStopSimplex = true;
+	} );
+
+	mSimplex->dual();
+
+	int None = -1;
+	if ( mSimplex->isProvenOptimal() &&
+		 Winner.compare_exchange_strong( None, static_cast<int>(eLPAlgorithm::DUAL_SIMPLEX) ) )
+		mStopBarrier = true;
+
+	// A cancelled barrier returns after its current iteration
+	BarrierThread.join();
+
+	mStopSimplex = false;
+	mStopBarrier = false;
+
+	if ( Winner == static_cast<int>(eLPAlgorithm::DUAL_SIMPLEX) )
+	{
+		mModel = mSimplex;
+		mIterationAlgorithm = eLPAlgorithm::DUAL_SIMPLEX;
+	}
+	else
+	{
+		mModel = mBarrier;
+		mIterationAlgorithm = eLPAlgorithm::BARRIER;
+	}
+}
+
 void
 CCoinDLOSolver::fBuildModel()
 {
@@ -120,26 +388,28 @@ CCoinDLOSolver::fBuildModel()
 void
 CCoinDLOSolver::fCalculateCompatibilityMatrix()
 {
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
-
-	std::vector<double> RowVector;
-	std::vector<std::vector<double>> Matrix;
-	RowVector.resize( 3, 0.0 );
-	Matrix.resize( 6, RowVector );
+	std::vector<CEdge*>& Edges = mActiveEdges;
+	CEdgeAssembly& Assembly = mAssembly;
 
-	size_t n1, n2;
 	size_t ColIndex = 0;
 
 	size_t Count = 0;
 
+	Assembly.Clear();
+
 	for (auto& Edge : Edges)
 	{
-		if (Edge->Added &&
-			 Edge->Type != eEdgeType::FREE &&
-			 Edge->Type != eEdgeType::SIMPLE_ANCHORED)
-			++Count;
+		if (Edge->Added)
+		{
+			Assembly.Add( Edge );
+
+			if (CEdgeAssembly::IsYielding( Edge->Class() ))
+				++Count;
+		}
 	}
 
+	Assembly.Assemble();
+
 	mObjP.resize( 2 * Count );
 
 	size_t NodeSize = mDomain->mNodes.size();
@@ -149,30 +419,13 @@ CCoinDLOSolver::fCalculateCompatibilityMatrix()
 	Count = 1;
 	int YieldingCount = 1;
 
-	std::array<size_t, 3> an1 = { 0,0,0 };
-	std::array<size_t, 3> an2 = { 0,0,0 };
-
 	for (size_t i = 0; i < Edges.size(); ++i)
 	{
 		if (Edges[i]->Added)
 		{
-			n1 = Edges[i]->N1;
-			n2 = Edges[i]->N2;
-
-			an1 = { 0,1,2 };
-			an2 = { 3,4,5 };
-
-			if (n1 > n2)
-			{
-				std::swap( n1, n2 );
-				an1 = { 3,4,5 };
-				an2 = { 0,1,2 };
-			}
-
-			Edges[i]->GetCompatibilityMatrix( Matrix, true );
+			bool Yielding = CEdgeAssembly::IsYielding( Edges[i]->Class() );
 
-			if (Edges[i]->Type != eEdgeType::FREE &&
-				 Edges[i]->Type != eEdgeType::SIMPLE_ANCHORED)
+			if (Yielding)
 			{
 				mObjP[2 * YieldingCount - 2] = Edges[i]->MpPos * Edges[i]->Length;
 				mObjP[2 * YieldingCount - 1] = Edges[i]->MpNeg * Edges[i]->Length;
@@ -184,83 +437,14 @@ CCoinDLOSolver::fCalculateCompatibilityMatrix()
 			{
 				col1 = mVal.size();
 
-				if (j == 0)
-				{
-					if (abs( Matrix[0][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an1[0]][j] );
-						mSub.push_back( static_cast<int>(3 * n1) - 3 );
-					}
-
-					if (abs( Matrix[1][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an1[1]][j] );
-						mSub.push_back( static_cast<int>(3 * n1) - 2 );
-					}
-
-					if (abs( Matrix[3][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an2[0]][j] );
-						mSub.push_back( static_cast<int>(3 * n2) - 3 );
-					}
-
-					if (abs( Matrix[4][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an2[1]][j] );
-						mSub.push_back( static_cast<int>(3 * n2) - 2 );
-					}
-				}
-				else if (j == 1)
-				{
-					if (abs( Matrix[0][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an1[0]][j] );
-						mSub.push_back( static_cast<int>(3 * n1) - 3 );
-					}
-
-					if (abs( Matrix[1][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an1[1]][j] );
-						mSub.push_back( static_cast<int>(3 * n1) - 2 );
-					}
-
-					if (abs( Matrix[2][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an1[2]][j] );
-						mSub.push_back( static_cast<int>(3 * n1) - 1 );
-					}
-
-					if (abs( Matrix[3][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an2[0]][j] );
-						mSub.push_back( static_cast<int>(3 * n2) - 3 );
-					}
-
-					if (abs( Matrix[4][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an2[1]][j] );
-						mSub.push_back( static_cast<int>(3 * n2) - 2 );
-					}
-
-					if (abs( Matrix[5][j] ) > 0)
-					{
-						mVal.push_back( Matrix[an2[2]][j] );
-						mSub.push_back( static_cast<int>(3 * n2) - 1 );
-					}
-				}
-				else if (j == 2)
-				{
-					mVal.push_back( Matrix[an1[2]][j] );
-					mSub.push_back( static_cast<int>(3 * n1) - 1 );
-
-					mVal.push_back( Matrix[an2[2]][j] );
-					mSub.push_back( static_cast<int>(3 * n2) - 1 );
-
-				}
+				const int* Rows = Assembly.GetRows( ColIndex );
+				const double* Values = Assembly.GetValues( ColIndex );
 
+				mSub.insert( mSub.end(), Rows, Rows + Assembly.GetCount( ColIndex ) );
+				mVal.insert( mVal.end(), Values, Values + Assembly.GetCount( ColIndex ) );
 
-				if (Edges[i]->Type != eEdgeType::FREE &&
-					 Edges[i]->Type != eEdgeType::SIMPLE_ANCHORED)
+				// The yield row of an edge holds its normal moment, column 0
+				if (Yielding && j == 0)
 				{
 					mVal.push_back( -1.0 );
 					mSub.push_back( static_cast<int>(Count + NodeSize * 3) - 1 );
@@ -268,7 +452,6 @@ CCoinDLOSolver::fCalculateCompatibilityMatrix()
 					++Count;
 				}
 
-
 				if (abs( mfL[ColIndex] ) > EPSILON)
 				{
 					mVal.push_back( mfL[ColIndex] );
@@ -280,13 +463,8 @@ CCoinDLOSolver::fCalculateCompatibilityMatrix()
 				mPtrb[ColIndex] = static_cast<int>(col1);
 				mPtre[ColIndex] = static_cast<int>(col2);
 
-				mModel->addColumn( mPtre[ColIndex] - mPtrb[ColIndex],
-								   &mSub[0] + mPtrb[ColIndex],
-								   &mVal[0] + mPtrb[ColIndex] );
-
 				++ColIndex;
 			}
-
 		}
 	}
 }
@@ -298,7 +476,7 @@ CCoinDLOSolver::fCalculatePlasticMultiplierTerms()
 
 	size_t ColumnIndex = mNumDisp;
 	size_t Row = 3 * mDomain->mNodes.size();
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
+	std::vector<CEdge*>& Edges = mActiveEdges;
 
 	size_t Count = 1;
 
@@ -319,10 +497,6 @@ CCoinDLOSolver::fCalculatePlasticMultiplierTerms()
 				mPtrb[ColumnIndex] = static_cast<int>(col1);
 				mPtre[ColumnIndex] = static_cast<int>(col2);
 
-				mModel->addColumn( mPtre[ColumnIndex] - mPtrb[ColumnIndex],
-								   &mSub[0] + mPtrb[ColumnIndex],
-								   &mVal[0] + mPtrb[ColumnIndex] );
-
 				++ColumnIndex;
 
 				col1 = mVal.size();
@@ -335,13 +509,314 @@ CCoinDLOSolver::fCalculatePlasticMultiplierTerms()
 				mPtrb[ColumnIndex] = static_cast<int>(col1);
 				mPtre[ColumnIndex] = static_cast<int>(col2);
 
-				mModel->addColumn( mPtre[ColumnIndex] - mPtrb[ColumnIndex],
-								   &mSub[0] + mPtrb[ColumnIndex],
-								   &mVal[0] + mPtrb[ColumnIndex] );
-
 				++ColumnIndex;
 				++Count;
 			}
 		}
 	}
-}
\ No newline at end of file
+}
+
+double*
+CCoinDLOSolver::fSolveEquilibrium( double& Objective )
+{
+	mNumDisp = fGetEdgeVarCount();
+	mNumYEdges = fGetYieldingEdges();
+	mNumDOF = fGetEdgeDOFCount();
+
+	if ( !mEquilibrium )
+		fBuildEquilibriumModel();
+
+	fRemoveEquilibriumEdges();
+	fAppendEquilibriumEdges();
+	fRunEquilibrium();
+
+	if ( !mEquilibrium->isProvenOptimal() )
+		return nullptr;
+
+	Objective = -mEquilibrium->objectiveValue();
+
+	// The columns are the duals of the kinematic LP: nodal forces, the
+	// moments on the yielding edges and the load factor
+	size_t NodeRows = mDomain->mNodes.size() * 3;
+	size_t numcon = NodeRows + mNumYEdges + 1;
+
+	const double* Values = mEquilibrium->primalColumnSolution();
+
+	double* Result = mArena.Allocate<double>( numcon );
+	if ( Result )
+	{
+		std::copy( Values, Values + NodeRows, Result );
+
+		size_t Row = NodeRows;
+		for ( auto Edge : mActiveEdges )
+		{
+			if ( Edge->Added &&
+				 Edge->Type != eEdgeType::FREE &&
+				 Edge->Type != eEdgeType::SIMPLE_ANCHORED )
+			{
+				Result[Row] = Values[mModelEdges[mModelIndex[Edge->Position]].Column];
+				++Row;
+			}
+		}
+
+		Result[numcon - 1] = Values[NodeRows];
+	}
+
+	fGetColumnSolution();
+
+	return Result;
+}
+
+void
+CCoinDLOSolver::fGetEquilibriumSolution()
+{
+	// Displacement jumps are the negated row duals, the plastic multipliers
+	// follow from the reduced cost of the moment column: p - m = -d
+	const double* RowDuals = mEquilibrium->dualRowSolution();
+	const double* Reduced = mEquilibrium->dualColumnSolution();
+
+	size_t Disp = 0;
+	size_t Mult = mNumDisp;
+
+	for ( auto Edge : mActiveEdges )
+	{
+		if ( Edge->Added )
+		{
+			const sModelEdge& ModelEdge = mModelEdges[mModelIndex[Edge->Position]];
+
+			for ( size_t j = 0; j < Edge->DOF(); ++j )
+				mResultArray[Disp++] = -RowDuals[ModelEdge.Row + j];
+
+			if ( ModelEdge.Column != -1 )
+			{
+				mResultArray[Mult++] = std::max( 0.0, -Reduced[ModelEdge.Column] );
+				mResultArray[Mult++] = std::max( 0.0, Reduced[ModelEdge.Column] );
+			}
+		}
+	}
+}
+
+void
+CCoinDLOSolver::fBuildEquilibriumModel()
+{
+	int NodeColumns = static_cast<int>(mDomain->mNodes.size() * 3);
+
+	mEquilibrium = new ClpSimplex();
+	mEquilibrium->setLogLevel( 0 );
+	mEquilibrium->resize( 0, NodeColumns + 1 );
+
+	// Free nodal forces followed by the load factor, which is maximised
+	for ( int i = 0; i <= NodeColumns; ++i )
+	{
+		mEquilibrium->setColumnLower( i, -COIN_DBL_MAX );
+		mEquilibrium->setColumnUpper( i, COIN_DBL_MAX );
+		mEquilibrium->setObjectiveCoefficient( i, 0.0 );
+	}
+
+	mEquilibrium->setObjectiveCoefficient( NodeColumns, -1.0 );
+
+	mModelIndex.assign( mDomain->mEdges.size(), kNotInModel );
+}
+
+void
+CCoinDLOSolver::fRunEquilibrium()
+{
+	if ( mRemovedColumns.size() )
+		mEquilibrium->deleteColumns( static_cast<int>(mRemovedColumns.size()), &mRemovedColumns[0] );
+	if ( mRemovedRows.size() )
+		mEquilibrium->deleteRows( static_cast<int>(mRemovedRows.size()), &mRemovedRows[0] );
+
+	if ( mRowBound.size() )
+	{
+		mEquilibrium->addRows( static_cast<int>(mRowBound.size()),
+							   &mRowBound[0], &mRowBound[0],
+							   &mRowStart[0], &mIndex[0], &mValue[0] );
+	}
+
+	if ( mCost.size() )
+	{
+		mEquilibrium->addColumns( static_cast<int>(mCost.size()),
+								  &mLower[0], &mUpper[0], &mCost[0],
+								  &mColumnStart[0], &mColumnIndex[0], &mColumnValue[0] );
+	}
+
+	mEquilibrium->setPrimalTolerance( mTolerance );
+	mEquilibrium->setDualTolerance( mTolerance );
+
+	// New rows leave the previous basis dual feasible
+	mEquilibrium->dual();
+	mIterationAlgorithm = eLPAlgorithm::DUAL_SIMPLEX;
+}
+
+void
+CCoinDLOSolver::fAppendEquilibriumEdges()
+{
+	std::array<double, 3> LiveVector, DeadVector;
+
+	std::vector<double>& RowBound = mRowBound;
+	std::vector<double>& Value = mValue;
+	std::vector<int>& RowStart = mRowStart;
+	std::vector<int>& Index = mIndex;
+
+	std::vector<double>& Lower = mLower;
+	std::vector<double>& Upper = mUpper;
+	std::vector<double>& Cost = mCost;
+	std::vector<double>& ColumnValue = mColumnValue;
+	std::vector<int>& ColumnStart = mColumnStart;
+	std::vector<int>& ColumnIndex = mColumnIndex;
+
+	RowBound.clear();
+	Value.clear();
+	RowStart.clear();
+	Index.clear();
+	Lower.clear();
+	Upper.clear();
+	Cost.clear();
+	ColumnValue.clear();
+	ColumnStart.clear();
+	ColumnIndex.clear();
+
+	// Numbered as in the model after the removals of fRemoveEquilibriumEdges
+	int NumRows = mEquilibrium->numberRows() - static_cast<int>(mRemovedRows.size());
+	int NumCols = mEquilibrium->numberColumns() - static_cast<int>(mRemovedColumns.size());
+	int LoadColumn = static_cast<int>(mDomain->mNodes.size() * 3);
+
+	mAssembly.Clear();
+
+	for ( auto Edge : mActiveEdges )
+	{
+		if ( Edge->Added && !fInModel( Edge ) )
+			mAssembly.Add( Edge );
+	}
+
+	mAssembly.Assemble();
+
+	size_t Column = 0;
+
+	for ( auto Edge : mActiveEdges )
+	{
+		if ( !Edge->Added || fInModel( Edge ) )
+			continue;
+
+		sModelEdge ModelEdge = { Edge, NumRows + static_cast<int>(RowBound.size()), -1 };
+
+		mDomain->fGetLoadVector( Edge, LiveVector, DeadVector );
+
+		size_t DOF = static_cast<size_t>(Edge->DOF());
+
+		for ( size_t j = 0; j < DOF; ++j, ++Column )
+		{
+			RowStart.push_back( static_cast<int>(Index.size()) );
+
+			fCalculateEdgeRow( Column, Index, Value );
+
+			if ( abs( LiveVector[j] ) > EPSILON )
+			{
+				Index.push_back( LoadColumn );
+				Value.push_back( LiveVector[j] );
+			}
+
+			RowBound.push_back( DeadVector[j] );
+		}
+
+		// The moment on a yielding edge is bounded by its plastic capacity
+		if ( Edge->Type != eEdgeType::FREE &&
+			 Edge->Type != eEdgeType::SIMPLE_ANCHORED )
+		{
+			ModelEdge.Column = NumCols + static_cast<int>(Cost.size());
+
+			ColumnStart.push_back( static_cast<int>(ColumnIndex.size()) );
+			ColumnIndex.push_back( ModelEdge.Row );
+			ColumnValue.push_back( -1.0 );
+
+			Lower.push_back( -Edge->MpNeg * Edge->Length );
+			Upper.push_back( Edge->MpPos * Edge->Length );
+			Cost.push_back( 0.0 );
+		}
+
+		fSetModelIndex( Edge, mModelEdges.size() );
+		mModelEdges.push_back( ModelEdge );
+	}
+
+	if ( RowBound.size() )
+		RowStart.push_back( static_cast<int>(Index.size()) );
+
+	if ( Cost.size() )
+		ColumnStart.push_back( static_cast<int>(ColumnIndex.size()) );
+}
+
+void
+CCoinDLOSolver::fRemoveEquilibriumEdges()
+{
+	std::vector<int>& Rows = mRemovedRows;
+	std::vector<int>& Columns = mRemovedColumns;
+
+	Rows.clear();
+	Columns.clear();
+
+	for ( const auto& ModelEdge : mModelEdges )
+	{
+		if ( ModelEdge.Edge->Added )
+			continue;
+
+		for ( int j = 0; j < ModelEdge.Edge->DOF(); ++j )
+			Rows.push_back( ModelEdge.Row + j );
+
+		if ( ModelEdge.Column != -1 )
+			Columns.push_back( ModelEdge.Column );
+	}
+
+	if ( Rows.empty() )
+		return;
+
+	// New index = old index less the number of removed entries before it,
+	// fRunEquilibrium removes them from the model
+	std::vector<int>& RowShift = mRowShift;
+	std::vector<int>& ColumnShift = mColumnShift;
+
+	RowShift.assign( mEquilibrium->numberRows() + 1, 0 );
+	ColumnShift.assign( mEquilibrium->numberColumns() + 1, 0 );
+
+	for ( auto Row : Rows )
+		++RowShift[Row + 1];
+	for ( auto Column : Columns )
+		++ColumnShift[Column + 1];
+
+	for ( size_t i = 1; i < RowShift.size(); ++i )
+		RowShift[i] += RowShift[i - 1];
+	for ( size_t i = 1; i < ColumnShift.size(); ++i )
+		ColumnShift[i] += ColumnShift[i - 1];
+
+	std::vector<sModelEdge>& ModelEdges = mKeptEdges;
+	ModelEdges.clear();
+
+	for ( auto ModelEdge : mModelEdges )
+	{
+		if ( !ModelEdge.Edge->Added )
+		{
+			fSetModelIndex( ModelEdge.Edge, kNotInModel );
+			continue;
+		}
+
+		ModelEdge.Row -= RowShift[ModelEdge.Row];
+		if ( ModelEdge.Column != -1 )
+			ModelEdge.Column -= ColumnShift[ModelEdge.Column];
+
+		fSetModelIndex( ModelEdge.Edge, ModelEdges.size() );
+		ModelEdges.push_back( ModelEdge );
+	}
+
+	mModelEdges.swap( ModelEdges );
+}
+
+void
+CCoinDLOSolver::fCalculateEdgeRow( size_t Column,
+								   std::vector<int>& Index,
+								   std::vector<double>& Value )
+{
+	const int* Rows = mAssembly.GetRows( Column );
+	const double* Values = mAssembly.GetValues( Column );
+
+	Index.insert( Index.end(), Rows, Rows + mAssembly.GetCount( Column ) );
+	Value.insert( Value.end(), Values, Values + mAssembly.GetCount( Column ) );
+}
@@ -5,27 +5,115 @@
 #pragma once
 
 #include "DLOSolver.h"
+#include "Enums.h"
 #include "ClpInterior.hpp"
 
+#include <atomic>
+
+class CEdge;
+class ClpSimplex;
+
 class CCoinDLOSolver : public CDLOSolver
 {
 public:
-	CCoinDLOSolver():
-		mModel( nullptr )
-	{
-	};
+	CCoinDLOSolver();
 
 	virtual ~CCoinDLOSolver();
 
+	double Solve( CDomain* Domain ) override;
+
+	// Falls back to the native Clp factorisation when the requested backend
+	// was not compiled in, see IsCholeskyAvailable.  GetCholesky returns the
+	// factorisation the barrier actually uses.
+	void SetCholesky( eCholeskyType Type ) { mCholesky = IsCholeskyAvailable( Type ) ? Type : eCholeskyType::NATIVE; };
+	eCholeskyType GetCholesky() { return mCholesky; };
 
+	static bool IsCholeskyAvailable( eCholeskyType Type );
+
+	// CONCURRENT races barrier against dual simplex on every LP and keeps the
+	// first optimal result, the winner is reported in the iteration stats.
+	// The winner cancels the other solver at the end of its next iteration.
+	void SetAlgorithm( eLPAlgorithm Algorithm ) { mAlgorithm = Algorithm; };
+	eLPAlgorithm GetAlgorithm() { return mAlgorithm; };
+
+	// EQUILIBRIUM solves the dual of the kinematic LP with dual simplex: nodal
+	// forces, moments and the load factor are the columns, every displacement
+	// DOF is a row.  Admitted edges become new rows of one persistent model.
+	// Lambda, mechanism and pricing duals are mapped back to the kinematic
+	// layout, the algorithm setting only applies to KINEMATIC.
+	void SetFormulation( eDLOFormulation Formulation ) { mFormulation = Formulation; };
+	eDLOFormulation GetFormulation() { return mFormulation; };
 
 protected:
+	friend class CAutoDLOSolver;
+
+	struct sModelEdge
+	{
+		CEdge* Edge;
+		int Row;
+		int Column;
+	};
+
+	// The solver with the solution of the last kinematic LP.  The solvers
+	// are kept for the whole solve and reloaded with every LP.
 	ClpModel* mModel = nullptr;
+	ClpSimplex* mSimplex = nullptr;
+	ClpInterior* mBarrier = nullptr;
+	std::atomic<bool> mStopSimplex;
+	std::atomic<bool> mStopBarrier;
+	eCholeskyType mCholesky;
+	eLPAlgorithm mAlgorithm;
+	eDLOFormulation mFormulation;
+
+	ClpSimplex* mEquilibrium;
+	std::vector<sModelEdge> mModelEdges;
+	std::vector<sModelEdge> mKeptEdges;
+
+	// Model edge of every domain edge by its Position, kNotInModel for the
+	// edges outside the model
+	static constexpr size_t kNotInModel = ~size_t( 0 );
+	std::vector<size_t> mModelIndex;
+
+	// Bounds and objective of the LP and the rows, columns and removals of
+	// the next equilibrium LP, these keep their capacity between iterations
+	std::vector<double> mLower, mUpper, mCost, mRowBound;
+	std::vector<double> mValue, mColumnValue;
+	std::vector<int> mRowStart, mIndex, mColumnStart, mColumnIndex;
+	std::vector<int> mRemovedRows, mRemovedColumns, mRowShift, mColumnShift;
+
+	ClpCholeskyBase* fCreateCholesky();
 	double* fSolve( double& Objective ) override;
 	void fGetColumnSolution() override;
+	void fReserveModel();
+
+	// All calls into Clp that load or solve an LP go through these two
+	virtual void fRunAlgorithm( int Columns,
+								int Rows );
+	virtual void fRunEquilibrium();
+
+	template<class tSolver>
+	void fLoadProblem( tSolver* Solver,
+					   int Columns,
+					   int Rows );
+	void fRunConcurrent( int Columns,
+						 int Rows );
 
 	void fBuildModel();
 	void fCalculateCompatibilityMatrix();
 	void fCalculatePlasticMultiplierTerms();
 
+	bool fInModel( const CEdge* Edge );
+	void fSetModelIndex( const CEdge* Edge,
+						 size_t Index );
+
+	void fResetModel();
+	double* fSolveEquilibrium( double& Objective );
+	void fGetEquilibriumSolution();
+	void fBuildEquilibriumModel();
+	void fAppendEquilibriumEdges();
+	void fRemoveEquilibriumEdges();
+	void fCalculateEdgeRow( size_t Column,
+							std::vector<int>& Index,
+							std::vector<double>& Value );
+
 };
\ No newline at end of file
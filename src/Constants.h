@@ -6,6 +6,13 @@
 
 #include "Vector2d.h"
 
+#include <cfloat>
+#include <cmath>
+
+// MSVC declares the floating point overloads of abs globally, libstdc++ and libc++ only in std
+using std::abs;
+
 #define PI 3.141592653589793238462643383279502884197169399375105820974944592307816406286
 #define EPSILON 1e-9
+#define LP_TOLERANCE 1e-8
 
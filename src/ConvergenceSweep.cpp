@@ -0,0 +1,227 @@
+// ConvergenceSweep.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "ConvergenceSweep.h"
+
+#include "Domain.h"
+#include "DLOSolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+CConvergenceSweep::CConvergenceSweep( tSetup Setup,
+									  tFactory Factory ):
+	mSetup( Setup ),
+	mFactory( Factory ),
+	mThreads( 0 ),
+	mDomainThreads( 1 ),
+	mLimit( 0 ),
+	mError( 0 ),
+	mOrder( 0 )
+{
+}
+
+double
+CConvergenceSweep::Solve( const std::vector<double>& Sizes )
+{
+	mLevels.clear();
+
+	for ( double Size : Sizes )
+		mLevels.push_back( { Size, 0, 0, 0, 0, "" } );
+
+	// The finest sizes take longest, they start first
+	std::sort( mLevels.begin(), mLevels.end(), []( const sSweepLevel& l, const sSweepLevel& r ) -> bool
+	{
+		return l.Size < r.Size;
+	} );
+
+	size_t Hardware = std::max( std::thread::hardware_concurrency(), 1u );
+	size_t Threads = mThreads > 0 ? static_cast<size_t>(mThreads) : Hardware;
+	Threads = std::max<size_t>( 1, std::min( Threads, mLevels.size() ) );
+
+	// Every worker builds edges on its share only, so the domains do not
+	// start a thread per hardware thread each
+	mDomainThreads = static_cast<int>(std::max<size_t>( 1, Hardware / Threads ));
+
+	std::atomic<size_t> Next( 0 );
+	std::vector<std::thread> Workers;
+
+	for ( size_t t = 0; t < Threads; ++t )
+	{
+		Workers.emplace_back( [this, &Next]()
+		{
+			for ( size_t i = Next++; i < mLevels.size(); i = Next++ )
+			{
+				// An exception must not leave the worker thread
+				try
+				{
+					fSolve( mLevels[i], i );
+				}
+				catch ( const std::exception& Error )
+				{
+					mLevels[i].Error = Error.what();
+				}
+				catch ( ... )
+				{
+					mLevels[i].Error = "Unknown error";
+				}
+			}
+		} );
+	}
+
+	for ( auto& Worker : Workers )
+		Worker.join();
+
+	for ( const auto& Level : mLevels )
+	{
+		if ( !Level.Error.empty() )
+			throw std::runtime_error( "The sweep level of size " + std::to_string( Level.Size ) + " failed: " + Level.Error );
+	}
+
+	fExtrapolate();
+
+	return mLimit;
+}
+
+void
+CConvergenceSweep::fSolve( sSweepLevel& Level,
+						   size_t Index )
+{
+	auto Start = std::chrono::steady_clock::now();
+
+	CDomain Domain;
+	Domain.SetThreads( mDomainThreads );
+	mSetup( Domain );
+
+	// Every level streams into its own pool file
+	if ( Domain.GetCandidateBudget() > 0 )
+		Domain.SetCandidateBudget( Domain.GetCandidateBudget(), Domain.GetCandidateFile() + "." + std::to_string( Index ) );
+
+	Domain.Discretize( Level.Size );
+	Domain.BuildEdges();
+
+	std::unique_ptr<CDLOSolver> Solver = mFactory();
+	Level.Lambda = Solver->Solve( &Domain );
+
+	std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+	Level.Nodes = Domain.GetNodes().size();
+	Level.Iterations = static_cast<int>(Solver->GetIterationStats().size());
+	Level.Time = Elapsed.count();
+}
+
+double
+CConvergenceSweep::fFit( double Order,
+						 double& Limit,
+						 double& Slope )
+{
+	// Least squares line through (h^Order, Lambda), returns the squared
+	// residual
+	size_t n = mLevels.size();
+	double mx = 0, my = 0;
+
+	for ( const auto& Level : mLevels )
+	{
+		mx += std::pow( Level.Size, Order ) / n;
+		my += Level.Lambda / n;
+	}
+
+	double Sxx = 0, Sxy = 0;
+	for ( const auto& Level : mLevels )
+	{
+		double dx = std::pow( Level.Size, Order ) - mx;
+		Sxx += dx * dx;
+		Sxy += dx * (Level.Lambda - my);
+	}
+
+	Slope = Sxx > 0 ? Sxy / Sxx : 0;
+	Limit = my - Slope * mx;
+
+	double Result = 0;
+	for ( const auto& Level : mLevels )
+	{
+		double r = Level.Lambda - Limit - Slope * std::pow( Level.Size, Order );
+		Result += r * r;
+	}
+
+	return Result;
+}
+
+void
+CConvergenceSweep::fExtrapolate()
+{
+	const double kMinOrder = 0.25;
+	const double kMaxOrder = 4;
+	const int kSteps = 64;
+
+	mLimit = 0;
+	mError = std::numeric_limits<double>::infinity();
+	mOrder = 0;
+
+	if ( mLevels.empty() )
+		return;
+
+	// Sorted finest first
+	double Finest = mLevels.front().Lambda;
+	double Slope;
+
+	if ( mLevels.size() == 1 )
+	{
+		mLimit = Finest;
+		return;
+	}
+
+	if ( mLevels.size() == 2 )
+	{
+		mOrder = 1;
+		fFit( mOrder, mLimit, Slope );
+		mError = std::abs( Finest - mLimit );
+		return;
+	}
+
+	// Scan the order, then narrow the best interval by golden section
+	double Best = kMinOrder;
+	double BestResidual = std::numeric_limits<double>::max();
+	double Step = (kMaxOrder - kMinOrder) / kSteps;
+
+	for ( int i = 0; i <= kSteps; ++i )
+	{
+		double Order = kMinOrder + i * Step;
+		double Limit;
+		double Residual = fFit( Order, Limit, Slope );
+
+		if ( Residual < BestResidual )
+		{
+			BestResidual = Residual;
+			Best = Order;
+		}
+	}
+
+	const double kGolden = 0.5 * (std::sqrt( 5.0 ) - 1);
+
+	double a = std::max( kMinOrder, Best - Step );
+	double b = std::min( kMaxOrder, Best + Step );
+
+	for ( int i = 0; i < 40; ++i )
+	{
+		double c = b - kGolden * (b - a);
+		double d = a + kGolden * (b - a);
+		double Limit;
+
+		if ( fFit( c, Limit, Slope ) < fFit( d, Limit, Slope ) )
+			b = d;
+		else
+			a = c;
+	}
+
+	mOrder = 0.5 * (a + b);
+	double Residual = fFit( mOrder, mLimit, Slope );
+
+	mError = std::abs( Finest - mLimit ) + std::sqrt( Residual / mLevels.size() );
+}
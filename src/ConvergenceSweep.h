@@ -0,0 +1,81 @@
+// ConvergenceSweep.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CDomain;
+class CDLOSolver;
+
+struct sSweepLevel
+{
+	double Size;
+	size_t Nodes;
+	int Iterations;
+	double Lambda;
+	double Time;
+
+	// What the level threw, empty when it solved
+	std::string Error;
+};
+
+// Solves one problem at a series of node spacings h, concurrently on a pool
+// of threads, and fits Lambda = Limit + b * h^Order to the load factors.
+// The limit extrapolates the load factor to h = 0, so a few coarse solves
+// stand in for a very fine one.  Every size gets its own domain, set up by
+// the setup callback before Discretize, and its own solver from the factory.
+// A candidate pool file set up for streamed candidates gets the level index
+// appended, so the levels solved at once do not share it.
+class CConvergenceSweep
+{
+public:
+	typedef std::function<void( CDomain& Domain )> tSetup;
+	typedef std::function<std::unique_ptr<CDLOSolver>()> tFactory;
+
+	CConvergenceSweep( tSetup Setup,
+					   tFactory Factory );
+	virtual ~CConvergenceSweep() {};
+
+	// Returns the extrapolated limit.  Throws std::runtime_error once all
+	// levels have finished when any of them threw, GetLevels then holds the
+	// error of every level.
+	double Solve( const std::vector<double>& Sizes );
+
+	// 0 uses a thread per hardware thread.  The hardware threads are shared
+	// out between the sizes solved at once, each domain builds its edges
+	// with its share; threads of the solvers are set by the factory.
+	void SetThreads( int Threads ) { mThreads = Threads; };
+	int GetThreads() { return mThreads; };
+
+	// The error estimate is the distance of the limit from the finest load
+	// factor plus the RMS residual of the fit.  Two sizes fit Order 1, one
+	// size gives no estimate.
+	double GetLimit() { return mLimit; };
+	double GetError() { return mError; };
+	double GetOrder() { return mOrder; };
+	const std::vector<sSweepLevel>& GetLevels() { return mLevels; };
+
+protected:
+	tSetup mSetup;
+	tFactory mFactory;
+	int mThreads;
+	int mDomainThreads;
+
+	std::vector<sSweepLevel> mLevels;
+	double mLimit;
+	double mError;
+	double mOrder;
+
+	void fSolve( sSweepLevel& Level,
+				 size_t Index );
+	double fFit( double Order,
+				 double& Limit,
+				 double& Slope );
+	void fExtrapolate();
+};
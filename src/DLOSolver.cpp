@@ -4,87 +4,116 @@
 
 #include "DLOSolver.h"
 
+#include "Constants.h"
 #include "Domain.h"
+#include "PricingPipeline.h"
 
 #include <algorithm>
+#include <chrono>
+#include <stdexcept>
 
 CDLOSolver::~CDLOSolver()
 {
 }
 
-void 
-CDLOSolver::fCalculateNodalForces( std::map<size_t, std::array<double, 3>>& Forces,
-								   double* rowDual )
+double
+CDLOSolver::fGetYieldRatio( CEdge* Edge,
+							double Lambda,
+							const double* F1,
+							const double* F2,
+							std::vector<std::vector<double>>& B )
 {
-	std::vector<CNode>& Nodes = mDomain->mNodes;
+	// Only reads the domain, the pricing workers call this concurrently
+	std::array<double, 3> EdgefL, EdgefD;
 
-	std::array<double, 3> Values = { 0,0,0 };
-	for ( size_t i = 0; i < Nodes.size(); ++i )
-		Forces[i + 1] = Values;
+	Edge->GetCompatibilityMatrix( B, false );
+	mDomain->fGetLoadVector( Edge, EdgefL, EdgefD );
 
-	for ( size_t i = 0; i < Nodes.size(); ++i )
-	{
-		Forces[i + 1][0] = rowDual[3 * (i + 1) - 3];
-		Forces[i + 1][1] = rowDual[3 * (i + 1) - 2];
-		Forces[i + 1][2] = rowDual[3 * (i + 1) - 1];
-	}
+	double Mn = 0;
+
+	for ( size_t Row = 0; Row < 3; ++Row )
+		Mn += B[Row][0] * F1[Row];
+
+	for ( size_t Row = 3; Row < 6; ++Row )
+		Mn += B[Row][0] * F2[Row - 3];
+
+	Mn += Lambda*EdgefL[0];
+	Mn += EdgefD[0];
+
+	if ( Mn < 0 )
+		return abs( Mn / (Edge->MpNeg*Edge->Length) );
+	else
+		return abs( Mn / (Edge->MpPos*Edge->Length) );
 }
 
-bool 
-CDLOSolver::fNewViolatedEdges( double Lambda,
-							   double* rowDual )
+void
+CDLOSolver::fCalculateYieldRatio( CEdge* Edge,
+								  double Lambda,
+								  const double* Forces,
+								  std::vector<std::vector<double>>& B )
 {
-	const double kYieldZero = 1e-6;
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
+	// The nodal forces are the first 3N row duals, node n at 3n - 3
+	Edge->YieldRatio = fGetYieldRatio( Edge, Lambda, Forces + 3 * Edge->N1 - 3, Forces + 3 * Edge->N2 - 3, B );
 
-	double LiveLoad = mDomain->mLiveLoad;
-	double DeadLoad = mDomain->mDeadLoad;
-
-	std::map<size_t, std::array<double, 3>> Forces;
-	fCalculateNodalForces( Forces, rowDual );
+	++mPriced;
+}
 
-	std::vector<double> Row = { 0,0,0 };
-	std::vector<std::vector<double>> B;
-	B.resize( 6, Row );
-	std::array<double, 3> EdgefL, EdgefD;
+double
+CDLOSolver::fCalculateYieldRatios( double Lambda,
+								   double* rowDual )
+{
+	std::vector<CEdge*>& Edges = mDomain->mEdges;
 
-	bool Result = false;
+	double Result = 0;
 
-	std::vector<CEdge*> NewEdges, OldEdges;
+	mBounds.Update( rowDual );
 
-	for ( auto Edge : Edges )
+	for ( size_t Group = 0; Group < mBounds.GetGroups(); ++Group )
 	{
-		if ( Edge->Removeable )
+		size_t Count;
+		const uint32_t* Index = mBounds.GetEdges( Group, Count );
+		double Bound = mBounds.GetBound( Group, Lambda );
+
+		// No edge of the group can yield, the bound stands in for the ratio
+		if ( Bound <= 1.0 )
 		{
-			Edge->GetCompatibilityMatrix( B, false );
-			Edge->GetUDLLoadVector( EdgefL, mDomain->mPoly );
-			EdgefD = EdgefL;
+			for ( size_t i = 0; i < Count; ++i )
+				Edges[Index[i]]->YieldRatio = Bound;
 
-			double Mn = 0;
+			Result = std::max( Result, Bound );
+			mSkipped += Count;
+			continue;
+		}
 
-			for ( size_t Row = 0; Row < 3; ++Row )
-				Mn += B[Row][0] * Forces[Edge->N1][Row];
+		Result = std::max( Result, mBounds.Price( Group, rowDual, Lambda, Edges ) );
+		mPriced += Count;
+	}
 
-			for ( size_t Row = 3; Row < 6; ++Row )
-				Mn += B[Row][0] * Forces[Edge->N2][Row - 3];
+	// Materialized candidates join after the groups were built
+	for ( size_t i = mBounds.GetEdgeCount(); i < Edges.size(); ++i )
+	{
+		if ( Edges[i]->Removeable )
+		{
+			fCalculateYieldRatio( Edges[i], Lambda, rowDual, mB );
+			Result = std::max( Result, Edges[i]->YieldRatio );
+		}
+	}
 
-			Mn += Lambda*EdgefL[0] * LiveLoad;
-			Mn += EdgefD[0] * DeadLoad;
+	return Result;
+}
 
-			if ( Mn < 0 )
-				Edge->YieldRatio = abs( Mn / (Edge->MpNeg*Edge->Length) );
-			else
-				Edge->YieldRatio = abs( Mn / (Edge->MpPos*Edge->Length) );
+size_t
+CDLOSolver::fGetAdmissionLimit()
+{
+	size_t Fraction = 5;
 
-			if ( Edge->YieldRatio - 1.0 > kYieldZero )
-			{
-				if ( !Edge->Added )
-					NewEdges.push_back( Edge );
-			}
-		}
-	}
+	return fGetEdgeCount()*Fraction/100;
+}
 
-	Result = NewEdges.size();
+bool
+CDLOSolver::fAdmitEdges( std::vector<CEdge*>& NewEdges )
+{
+	bool Result = NewEdges.size();
 
 	if ( Result )
 	{
@@ -94,9 +123,7 @@ CDLOSolver::fNewViolatedEdges( double Lambda,
 			return l->YieldRatio > r->YieldRatio;
 		} );
 
-		size_t Fraction = 5;
-
-		size_t NumberToUse = fGetEdgeCount()*Fraction/100;
+		size_t NumberToUse = fGetAdmissionLimit();
 		if ( NumberToUse == 0 )
 			NumberToUse = NewEdges.size();
 		if ( NumberToUse > NewEdges.size() )
@@ -113,6 +140,543 @@ CDLOSolver::fNewViolatedEdges( double Lambda,
 			else
 				break;
 		}
+
+		NewEdges.resize( NumberToUse );
+		fUpdateActiveEdges( NewEdges );
+	}
+
+	return Result;
+}
+
+bool
+CDLOSolver::fPricePartial( double Lambda,
+						   double* rowDual )
+{
+	const double kYieldZero = 1e-6;
+	const double kStrongYield = 1.1;
+	std::vector<CEdge*>& Edges = mDomain->mEdges;
+
+	// Collect twice what can be admitted so the best of them are chosen
+	size_t Wanted = 2 * std::max<size_t>( fGetAdmissionLimit(), 1 );
+	size_t Strong = 0;
+
+	std::vector<CEdge*>& NewEdges = mNewEdges;
+	NewEdges.clear();
+
+	if ( mCursor >= Edges.size() )
+		mCursor = 0;
+
+	for ( size_t i = 0; i < Edges.size() && Strong < Wanted; ++i )
+	{
+		CEdge* Edge = Edges[mCursor];
+		mCursor = (mCursor + 1) % Edges.size();
+
+		if ( !Edge->Removeable || Edge->Added )
+			continue;
+
+		fCalculateYieldRatio( Edge, Lambda, rowDual, mB );
+
+		if ( Edge->YieldRatio - 1.0 > kYieldZero )
+		{
+			NewEdges.push_back( Edge );
+
+			if ( Edge->YieldRatio > kStrongYield )
+				++Strong;
+		}
+	}
+
+	// Compact or streamed candidates are swept in full once the edges come
+	// up short, so a round without violations has still priced everything
+	if ( Strong < Wanted )
+		fPriceCandidates( Lambda, rowDual, NewEdges );
+
+	return fAdmitEdges( NewEdges );
+}
+
+bool 
+CDLOSolver::fNewViolatedEdges( double Lambda,
+							   double* rowDual )
+{
+	const double kYieldZero = 1e-6;
+	std::vector<CEdge*>& Edges = mDomain->mEdges;
+
+	fCalculateYieldRatios( Lambda, rowDual );
+
+	std::vector<CEdge*>& NewEdges = mNewEdges;
+	NewEdges.clear();
+
+	for ( auto Edge : Edges )
+	{
+		if ( Edge->Removeable &&
+			 !Edge->Added &&
+			 Edge->YieldRatio - 1.0 > kYieldZero )
+			NewEdges.push_back( Edge );
+	}
+
+	fPriceCandidates( Lambda, rowDual, NewEdges );
+
+	return fAdmitEdges( NewEdges );
+}
+
+void
+CDLOSolver::fPriceCandidates( double Lambda,
+							  double* rowDual,
+							  std::vector<CEdge*>& NewEdges )
+{
+	const double kYieldZero = 1e-6;
+
+	size_t Count = mDomain->fGetCandidateCount();
+	if ( Count == 0 )
+		return;
+
+	struct sViolated
+	{
+		double Ratio;
+		size_t Index;
+		sCandidateEdge Candidate;
+	};
+
+	auto ByRatio = []( const sViolated& l, const sViolated& r ) -> bool
+	{
+		return l.Ratio > r.Ratio;
+	};
+
+	// Only as many candidates as can be admitted are kept, in a heap with
+	// the weakest on top, so memory does not grow with the violations
+	size_t Limit = fGetAdmissionLimit();
+	if ( Limit == 0 )
+		Limit = Count;
+
+	std::vector<sViolated> Violated;
+
+	double Load = Lambda * mDomain->mLiveLoad + mDomain->mDeadLoad;
+	const CLoadTable& Loads = mDomain->mLoads;
+	const std::vector<size_t>& Materialized = mDomain->mMaterialized;
+	size_t Next = 0;
+
+	size_t LoadWidth = Loads.GetCount();
+
+	auto Price = [&]( const sCandidateEdge* Candidates, const float* Factors, size_t Size, size_t First )
+	{
+		for ( size_t i = 0; i < Size; ++i )
+		{
+			// Materialized candidates are priced as edges
+			while ( Next < Materialized.size() && Materialized[Next] < First + i )
+				++Next;
+			if ( Next < Materialized.size() && Materialized[Next] == First + i )
+				continue;
+
+			const sCandidateEdge& Candidate = Candidates[i];
+
+			const double* F1 = rowDual + 3 * Candidate.N1 - 3;
+			const double* F2 = rowDual + 3 * Candidate.N2 - 3;
+
+			double Mn = Candidate.c * (F1[0] - F2[0]) +
+				Candidate.s * (F1[1] - F2[1]) +
+				Load * Candidate.UDL +
+				Loads.GetCandidateWork( Factors ? Factors + LoadWidth * i : nullptr, Lambda );
+
+			double Mp = Mn < 0 ? Candidate.MpNeg : Candidate.MpPos;
+			double Ratio = abs( Mn / (Mp * Candidate.Length) );
+
+			if ( Ratio - 1.0 <= kYieldZero )
+				continue;
+
+			if ( Violated.size() < Limit )
+			{
+				Violated.push_back( { Ratio, First + i, Candidate } );
+				std::push_heap( Violated.begin(), Violated.end(), ByRatio );
+			}
+			else if ( Ratio > Violated.front().Ratio )
+			{
+				std::pop_heap( Violated.begin(), Violated.end(), ByRatio );
+				Violated.back() = { Ratio, First + i, Candidate };
+				std::push_heap( Violated.begin(), Violated.end(), ByRatio );
+			}
+		}
+	};
+
+	if ( mDomain->mPool.IsOpen() )
+	{
+		if ( !mDomain->mPool.ForEach( Price ) )
+			throw std::runtime_error( "Mapping the candidate pool failed" );
+	}
+	else
+		Price( &mDomain->mCandidates[0], Loads.GetCandidateRows(), Count, 0 );
+
+	mPriced += Count;
+
+	std::sort_heap( Violated.begin(), Violated.end(), ByRatio );
+
+	// The ratio is recomputed in double precision before they compete
+	for ( auto& Entry : Violated )
+	{
+		CEdge* Edge = mDomain->fMaterialize( Entry.Index, Entry.Candidate );
+
+		Edge->YieldRatio = fGetYieldRatio( Edge, Lambda, rowDual + 3 * Edge->N1 - 3, rowDual + 3 * Edge->N2 - 3, mB );
+
+		if ( Edge->YieldRatio - 1.0 > kYieldZero )
+			NewEdges.push_back( Edge );
+	}
+}
+
+bool
+CDLOSolver::fPriceSmoothed( double Lambda,
+							double* rowDual )
+{
+	const double kYieldZero = 1e-6;
+	std::vector<CEdge*>& Edges = mDomain->mEdges;
+	size_t NodeRows = mDomain->mNodes.size() * 3;
+
+	// Price the current duals first, only they can prove optimality.  The
+	// sweep of compact or streamed candidates materializes the ones the
+	// current duals violate, only those may be admitted below.
+	double MaxRatio = fCalculateYieldRatios( Lambda, rowDual );
+
+	std::vector<CEdge*>& NewEdges = mNewEdges;
+	NewEdges.clear();
+	fPriceCandidates( Lambda, rowDual, NewEdges );
+
+	for ( auto Edge : NewEdges )
+		MaxRatio = std::max( MaxRatio, Edge->YieldRatio );
+
+	double* CurrentRatio = mArena.Allocate<double>( Edges.size() );
+	bool Violated = false;
+
+	for ( size_t i = 0; i < Edges.size(); ++i )
+	{
+		CurrentRatio[i] = Edges[i]->YieldRatio;
+
+		if ( Edges[i]->Removeable &&
+			 !Edges[i]->Added &&
+			 Edges[i]->YieldRatio - 1.0 > kYieldZero )
+			Violated = true;
+	}
+
+	if ( !Violated )
+		return false;
+
+	// Scaling the forces by the largest yield ratio gives a safe field, so
+	// Lambda / MaxRatio bounds the collapse load from below
+	double Bound = Lambda / std::max( MaxRatio, 1.0 );
+
+	if ( mCenter.empty() || Bound > mCenterBound )
+	{
+		mCenter.assign( rowDual, rowDual + NodeRows );
+		mCenterLambda = Lambda;
+		mCenterBound = Bound;
+	}
+
+	double* Smoothed = mArena.Allocate<double>( NodeRows );
+	for ( size_t i = 0; i < NodeRows; ++i )
+		Smoothed[i] = mSmoothing * mCenter[i] + (1.0 - mSmoothing) * rowDual[i];
+
+	fCalculateYieldRatios( mSmoothing * mCenterLambda + (1.0 - mSmoothing) * Lambda, Smoothed );
+
+	// Only edges that are also violated by the current duals improve the LP
+	NewEdges.clear();
+
+	for ( size_t i = 0; i < Edges.size(); ++i )
+	{
+		if ( Edges[i]->Removeable &&
+			 !Edges[i]->Added &&
+			 Edges[i]->YieldRatio - 1.0 > kYieldZero &&
+			 CurrentRatio[i] - 1.0 > kYieldZero )
+			NewEdges.push_back( Edges[i] );
+	}
+
+	// Mispricing: fall back to the current duals so the method still converges
+	if ( NewEdges.empty() )
+	{
+		++mMisprices;
+		if ( mStats.size() )
+			mStats.back().Mispriced = true;
+
+		for ( size_t i = 0; i < Edges.size(); ++i )
+		{
+			Edges[i]->YieldRatio = CurrentRatio[i];
+
+			if ( Edges[i]->Removeable &&
+				 !Edges[i]->Added &&
+				 Edges[i]->YieldRatio - 1.0 > kYieldZero )
+				NewEdges.push_back( Edges[i] );
+		}
+	}
+
+	return fAdmitEdges( NewEdges );
+}
+
+double*
+CDLOSolver::fSolveIteration( double& Objective )
+{
+	auto Start = std::chrono::steady_clock::now();
+
+	// The duals of the previous LP are dead once the next one is solved
+	mArena.Reset();
+
+	double* Result = fSolve( Objective );
+
+	if ( Result )
+		mForces.assign( Result, Result + mDomain->mNodes.size() * 3 );
+
+	std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+	sIterationStats Stats;
+	Stats.Iteration = static_cast<int>(mStats.size()) + 1;
+	Stats.Columns = mNumDisp + mNumYEdges * 2;
+	Stats.Rows = mDomain->mNodes.size() * 3 + mNumYEdges + 1;
+	Stats.Objective = Objective;
+	Stats.LPTime = Elapsed.count();
+	Stats.PricingTime = 0;
+	Stats.Algorithm = mIterationAlgorithm;
+	Stats.Mispriced = false;
+	Stats.Dropped = 0;
+	Stats.Priced = 0;
+	Stats.Admitted = 0;
+	Stats.Tolerance = mTolerance;
+	Stats.IOTime = 0;
+	Stats.Skipped = 0;
+
+	mStats.push_back( Stats );
+
+	return Result;
+}
+
+void
+CDLOSolver::fAgeEdges( std::vector<CEdge*>& Expired )
+{
+	// After kMaxDrops drops an edge stays in the LP
+	const double kInactive = 1e-9;
+
+	size_t Mult = mNumDisp;
+
+	for ( auto Edge : mActiveEdges )
+	{
+		if ( Edge->Type == eEdgeType::FREE ||
+			 Edge->Type == eEdgeType::SIMPLE_ANCHORED )
+			continue;
+
+		double Plastic = mResultArray[Mult] + mResultArray[Mult + 1];
+		Mult += 2;
+
+		if ( !Edge->Removeable )
+			continue;
+
+		if ( Plastic > kInactive )
+			Edge->Age = 0;
+		else
+			++Edge->Age;
+
+		if ( Edge->Age >= mMaxAge && Edge->Drops < kMaxDrops )
+			Expired.push_back( Edge );
+	}
+}
+
+bool
+CDLOSolver::fPriceIteration( double Lambda,
+							 double* rowDual )
+{
+	auto Start = std::chrono::steady_clock::now();
+
+	// Aging reads the multipliers of the LP just solved, before pricing
+	// changes the set of admitted edges
+	std::vector<CEdge*>& Expired = mExpired;
+	Expired.clear();
+	if ( mMaxAge > 0 && mResultArray )
+		fAgeEdges( Expired );
+
+	size_t Before = fGetEdgeCount();
+	double IOTime = mDomain->GetCandidateIOTime();
+
+	mPriced = 0;
+	mSkipped = 0;
+
+	bool Result;
+	if ( mSmoothing > 0 )
+		Result = fPriceSmoothed( Lambda, rowDual );
+	else if ( mPartialPricing )
+		Result = fPricePartial( Lambda, rowDual );
+	else
+		Result = fNewViolatedEdges( Lambda, rowDual );
+
+	// Expired edges are dual feasible for the current duals, so dropping them
+	// keeps the current solution optimal.  Only drop when another LP follows,
+	// the final result array must match the admitted edges.
+	if ( Result && Expired.size() )
+	{
+		for ( auto Edge : Expired )
+		{
+			Edge->Added = false;
+			Edge->Age = 0;
+			++Edge->Drops;
+		}
+
+		std::vector<CEdge*> None;
+		fUpdateActiveEdges( None );
+	}
+
+	std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+	if ( mStats.size() )
+	{
+		mStats.back().PricingTime = Elapsed.count();
+		mStats.back().Dropped = Result ? Expired.size() : 0;
+		mStats.back().Priced = mPriced;
+		mStats.back().Skipped = mSkipped;
+		mStats.back().Admitted = fGetEdgeCount() + mStats.back().Dropped - Before;
+		mStats.back().IOTime = mDomain->GetCandidateIOTime() - IOTime;
+	}
+
+	return Result;
+}
+
+bool
+CDLOSolver::fIsTight()
+{
+	return mTolerance <= LP_TOLERANCE;
+}
+
+bool
+CDLOSolver::fScheduleTolerance( double Old,
+								double Objective,
+								bool Solved,
+								bool Violations )
+{
+	if ( !Solved || fIsTight() )
+		return Violations;
+
+	// Duals of a loose LP can not certify the mechanism, re-solve tight
+	// before accepting an iteration without violations
+	if ( !Violations )
+	{
+		mTolerance = LP_TOLERANCE;
+		return true;
+	}
+
+	// Tighten once the objective settles or only a few edges are admitted,
+	// never loosen again
+	size_t Admitted = mStats.size() ? mStats.back().Admitted : 0;
+	double Change = abs( Objective - Old ) / std::max( abs( Objective ), 1.0 );
+	bool Settled = mStats.size() > 1 && Change < 1e-3;
+
+	if ( Settled || Admitted < fGetAdmissionLimit() )
+		mTolerance = std::max( mTolerance * 0.1, LP_TOLERANCE );
+
+	return true;
+}
+
+double
+CDLOSolver::fSolvePipelined()
+{
+	double Result = 0;
+	double Old = 0;
+	int SameCount = 0;
+	size_t NodeRows = mDomain->mNodes.size() * 3;
+
+	const double kYieldZero = 1e-6;
+
+	// Lambda and Duals are the ones of the sweep in flight, the workers and
+	// the lists below are kept for the whole solve
+	double Lambda = 0;
+	std::vector<double> Duals;
+	std::vector<CEdge*> Candidates;
+	std::vector<CEdge*> NewEdges;
+	std::vector<CEdge*> Pending;
+
+	CPricingPipeline Pipeline( mPipelineThreads, [this, &Lambda, &Duals]( CEdge* Edge, std::vector<std::vector<double>>& B ) -> double
+	{
+		return fGetYieldRatio( Edge, Lambda, &Duals[3 * Edge->N1 - 3], &Duals[3 * Edge->N2 - 3], B );
+	} );
+
+	double *dualRow = fSolveIteration( Result );
+
+	while ( dualRow )
+	{
+		auto Start = std::chrono::steady_clock::now();
+		size_t Index = mStats.size() - 1;
+
+		Lambda = Result;
+		Duals.assign( dualRow, dualRow + NodeRows );
+
+		Candidates.clear();
+		for ( auto Edge : mDomain->mEdges )
+		{
+			if ( Edge->Removeable && !Edge->Added )
+				Candidates.push_back( Edge );
+		}
+
+		Pipeline.Start( Candidates );
+
+		size_t Wanted = 2 * std::max<size_t>( fGetAdmissionLimit(), 1 );
+		Pipeline.WaitFor( Wanted );
+
+		NewEdges.clear();
+		Pipeline.Drain( NewEdges );
+
+		size_t Before = fGetEdgeCount();
+
+		// Edges queued against older duals only join a round that admits
+		// edges anyway, they can not keep the solve going.  They are priced
+		// again against the current duals, the sweep may not have reached
+		// them yet.
+		bool Violations = NewEdges.size() > 0;
+		if ( Violations )
+		{
+			for ( auto Edge : Pending )
+			{
+				if ( Edge->Added )
+					continue;
+
+				Edge->YieldRatio = fGetYieldRatio( Edge, Lambda, &Duals[3 * Edge->N1 - 3], &Duals[3 * Edge->N2 - 3], mB );
+
+				if ( Edge->YieldRatio - 1.0 > kYieldZero )
+					NewEdges.push_back( Edge );
+			}
+
+			// An edge drained from this sweep and re-priced from Pending has
+			// the same ratio, either copy is kept
+			std::sort( NewEdges.begin(), NewEdges.end() );
+			NewEdges.erase( std::unique( NewEdges.begin(), NewEdges.end() ), NewEdges.end() );
+
+			fAdmitEdges( NewEdges );
+		}
+		Pending.clear();
+
+		std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+		mStats[Index].PricingTime = Elapsed.count();
+		mStats[Index].Admitted = fGetEdgeCount() - Before;
+
+		Violations = fScheduleTolerance( Old, Result, true, Violations );
+
+		if ( !Violations )
+		{
+			mStats[Index].Priced = Pipeline.GetPriced();
+			break;
+		}
+
+		Old = Result;
+
+		// The rest of the sweep runs on the old duals while the next LP solves
+		dualRow = fSolveIteration( Result );
+
+		Pipeline.Wait();
+		Pipeline.Drain( Pending );
+
+		mStats[Index].Priced = Pipeline.GetPriced();
+
+		if ( abs( Old - Result ) < 1e-6 )
+			++SameCount;
+		else
+			SameCount = 0;
+
+		if ( SameCount == 10 )
+		{
+			if ( fIsTight() )
+				break;
+
+			mTolerance = LP_TOLERANCE;
+			SameCount = 0;
+		}
 	}
 
 	return Result;
@@ -122,113 +686,248 @@ double
 CDLOSolver::Solve( CDomain* Domain )
 {
 	double Result = 0;
-	double Old;
+	double Old = 0;
 	int IterationCount = 1;
 	int SameCount = 0;
 
+	// Without its pool a streamed domain would be solved over the boundary
+	// and mesh edges only
+	if ( Domain->mBudget > 0 && !Domain->mPool.IsOpen() )
+		throw std::runtime_error( "The candidate pool of the domain was not built" );
+
 	mDomain = Domain;
+	mStats.clear();
+	mCenter.clear();
+	mForces.clear();
+	mMisprices = 0;
+	mCursor = 0;
+	mTolerance = std::max( mLooseTolerance, LP_TOLERANCE );
+
+	for ( size_t i = 0; i < Domain->mEdges.size(); ++i )
+	{
+		Domain->mEdges[i]->Age = 0;
+		Domain->mEdges[i]->Drops = 0;
+		Domain->mEdges[i]->Position = i;
+	}
 
-	double *dualRow = fSolve( Result );
-	bool Violations = dualRow ? fNewViolatedEdges( Result, dualRow ) : false;
-	delete[] dualRow;
+	fReserveIteration();
+	fBuildActiveEdges();
+
+	fBuildBounds();
+
+	// Violated edges of the initial forces join the first LP, also before a
+	// pipelined solve
+	mInitialAdmitted = 0;
+	if ( mInitialForces.size() == Domain->mNodes.size() * 3 )
+	{
+		fNewViolatedEdges( mInitialLambda, &mInitialForces[0] );
+		mInitialAdmitted = mNewEdges.size();
+	}
+	mInitialForces.clear();
+
+	if ( mPipelineThreads > 0 && Domain->fGetCandidateCount() == 0 )
+		return fSolvePipelined();
+
+	double *dualRow = fSolveIteration( Result );
+	bool Solved = dualRow != nullptr;
+	bool Violations = Solved ? fPriceIteration( Result, dualRow ) : false;
+
+	Violations = fScheduleTolerance( Old, Result, Solved, Violations );
 
 	while ( Violations )
 	{
 		Old = Result;
 		++IterationCount;
-		dualRow = fSolve( Result );
 
-		if ( abs( Old - Result ) < 1e-6 )
+		// Dropping aged edges keeps the objective, such rounds do not count
+		// as stagnation
+		bool Dropped = mStats.size() && mStats.back().Dropped;
+
+		dualRow = fSolveIteration( Result );
+		Solved = dualRow != nullptr;
+
+		if ( abs( Old - Result ) < 1e-6 && !Dropped )
 			++SameCount;
 		else
 			SameCount = 0;
 
 		if ( SameCount == 10 )
-			break;
+		{
+			// A loose LP may stall on its own inaccuracy
+			if ( fIsTight() )
+				break;
 
-		Violations = dualRow ? fNewViolatedEdges( Result, dualRow ) : false;
-		delete[] dualRow;
+			mTolerance = LP_TOLERANCE;
+			SameCount = 0;
+		}
+
+		Violations = Solved ? fPriceIteration( Result, dualRow ) : false;
+
+		Violations = fScheduleTolerance( Old, Result, Solved, Violations );
 	}
 
 	return Result;
 }
 
-size_t
-CDLOSolver::fGetEdgeDOFCount()
+void
+CDLOSolver::fBuildActiveEdges()
 {
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
+	mActiveEdges.clear();
 
-	size_t Result = 0;
-	for ( size_t i = 0; i < Edges.size(); ++i )
+	for ( auto Edge : mDomain->mEdges )
 	{
-		if ( Edges[i]->Added )
-			Result += Edges[i]->DOF();
+		if ( Edge->Added )
+			mActiveEdges.push_back( Edge );
 	}
 
-	return Result;
+	fCalculateOffsets();
 }
 
-size_t
-CDLOSolver::fGetEdgeVarCount()
+void
+CDLOSolver::fUpdateActiveEdges( std::vector<CEdge*>& Admitted )
 {
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
+	// Dropped edges leave, admitted edges are merged in by their position in
+	// mEdges, which keeps the column layout of a full rebuild
+	mActiveEdges.erase( std::remove_if( mActiveEdges.begin(), mActiveEdges.end(), []( const CEdge* Edge ) -> bool
+	{
+		return !Edge->Added;
+	} ), mActiveEdges.end() );
 
-	size_t Result = 0;
-	for ( size_t i = 0; i < Edges.size(); ++i )
+	auto ByPosition = []( const CEdge* l, const CEdge* r ) -> bool
 	{
-		if ( Edges[i]->Added )
-		{
-			if ( Edges[i]->Type == eEdgeType::FREE ||
-				 Edges[i]->Type == eEdgeType::SYMMETRY )
-			{
-				Result += 3;
-			}
-			else
-				++Result;
-		}
-	}
+		return l->Position < r->Position;
+	};
 
-	return Result;
+	std::sort( Admitted.begin(), Admitted.end(), ByPosition );
+
+	// inplace_merge would allocate a buffer, merge into the spare list
+	mMerged.resize( mActiveEdges.size() + Admitted.size() );
+	std::merge( mActiveEdges.begin(), mActiveEdges.end(), Admitted.begin(), Admitted.end(), mMerged.begin(), ByPosition );
+	mActiveEdges.swap( mMerged );
+
+	fCalculateOffsets();
 }
 
-size_t
-CDLOSolver::fGetYieldingEdges()
+void
+CDLOSolver::fReserveIteration()
+{
+	// Upper bounds for the whole solve: every edge admitted, three DOFs and
+	// a yield row each.  Only the stats grow past a long solve.
+	const size_t kIterations = 256;
+
+	size_t Edges = mDomain->mEdges.size();
+	size_t NodeRows = mDomain->mNodes.size() * 3;
+
+	mActiveEdges.reserve( Edges );
+	mMerged.reserve( Edges );
+	mNewEdges.reserve( Edges );
+	mExpired.reserve( Edges );
+	mDOFOffsets.reserve( Edges + 1 );
+	mYieldOffsets.reserve( Edges + 1 );
+	mAssembly.Reserve( Edges );
+	mCenter.reserve( NodeRows );
+	mForces.reserve( NodeRows );
+	mStats.reserve( kIterations );
+
+	mResult.reserve( 5 * Edges );
+	mfL.reserve( 3 * Edges );
+	mfD.reserve( 3 * Edges );
+	mObjP.reserve( 2 * Edges );
+	mPtrb.reserve( 5 * Edges + 1 );
+	mPtre.reserve( 5 * Edges );
+
+	// A displacement column holds its assembly entries, a yield row and a
+	// load entry, a multiplier column one entry
+	size_t Entries = 3 * Edges * (CEdgeAssembly::kMaxEntries + 2) + 2 * Edges;
+	mSub.reserve( Entries );
+	mVal.reserve( Entries );
+
+	// Row duals, smoothed forces and the current ratios of smoothed pricing
+	size_t Doubles = (NodeRows + Edges + 1) + NodeRows + Edges;
+	mArena.Reserve( Doubles * sizeof( double ) + 3 * alignof(double) );
+}
+
+void
+CDLOSolver::fBuildBounds()
 {
 	std::vector<CEdge*>& Edges = mDomain->mEdges;
-	size_t Result = 0;
+
+	std::vector<double> Live( Edges.size(), 0.0 );
+	std::vector<double> Dead( Edges.size(), 0.0 );
+
 	for ( size_t i = 0; i < Edges.size(); ++i )
 	{
-		if ( Edges[i]->Added )
-		{
-			if ( Edges[i]->Type != eEdgeType::FREE &&
-				 Edges[i]->Type != eEdgeType::SIMPLE_ANCHORED )
-			{
-				++Result;
-			}
-		}
+		if ( !Edges[i]->Removeable )
+			continue;
+
+		std::array<double, 3> EdgefL, EdgefD;
+		mDomain->fGetLoadVector( Edges[i], EdgefL, EdgefD );
+
+		Live[i] = EdgefL[0];
+		Dead[i] = EdgefD[0];
 	}
 
-	return Result;
+	mBounds.Build( Edges, Edges.size(), mDomain->mNodes, Live, Dead );
 }
 
-size_t
-CDLOSolver::fGetEdgeCount()
+double*
+CDLOSolver::fResizeResult( size_t Size )
 {
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
-	size_t Result = 0;
-	for ( size_t i = 0; i < Edges.size(); ++i )
+	mSize = Size;
+	mResult.resize( Size );
+	mResultArray = Size ? &mResult[0] : nullptr;
+
+	return mResultArray;
+}
+
+void
+CDLOSolver::fCalculateOffsets()
+{
+	size_t Size = mActiveEdges.size() + 1;
+
+	mDOFOffsets.assign( Size, 0 );
+	mYieldOffsets.assign( Size, 0 );
+
+	for ( size_t i = 0; i < mActiveEdges.size(); ++i )
 	{
-		if ( Edges[i]->Added )
-			++Result;
+		CEdge* Edge = mActiveEdges[i];
+
+		bool Yielding = Edge->Type != eEdgeType::FREE &&
+			Edge->Type != eEdgeType::SIMPLE_ANCHORED;
+
+		mDOFOffsets[i + 1] = mDOFOffsets[i] + Edge->DOF();
+		mYieldOffsets[i + 1] = mYieldOffsets[i] + (Yielding ? 1 : 0);
 	}
+}
 
-	return Result;
+size_t
+CDLOSolver::fGetEdgeDOFCount()
+{
+	return mDOFOffsets.size() ? mDOFOffsets.back() : 0;
+}
+
+size_t
+CDLOSolver::fGetEdgeVarCount()
+{
+	return fGetEdgeDOFCount();
+}
+
+size_t
+CDLOSolver::fGetYieldingEdges()
+{
+	return mYieldOffsets.size() ? mYieldOffsets.back() : 0;
+}
+
+size_t
+CDLOSolver::fGetEdgeCount()
+{
+	return mActiveEdges.size();
 }
 
 std::vector<double> 
 CDLOSolver::GetEdgeData()
 {
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
+	std::vector<CEdge*>& Edges = mActiveEdges;
 	std::vector<CNode>& Nodes = mDomain->mNodes;
 
 	int YieldCount = 1, RowCount = 1;
@@ -6,15 +6,55 @@
 
 #include <vector>
 #include <map>
+#include <array>
+#include <cstddef>
+
+#include "EdgeAssembly.h"
+#include "Enums.h"
+#include "IterationArena.h"
+#include "PricingBounds.h"
 
 class CDomain;
+class CEdge;
+
+struct sIterationStats
+{
+	int Iteration;
+	size_t Columns;
+	size_t Rows;
+	double Objective;
+	double LPTime;
+	double PricingTime;
+	eLPAlgorithm Algorithm;
+	bool Mispriced;
+	size_t Dropped;
+	size_t Priced;
+	size_t Admitted;
+	double Tolerance;
+	double IOTime;
+	size_t Skipped;
+};
 
 class CDLOSolver
 {
 public:
 	CDLOSolver():
 		mResultArray(nullptr),
-		mSize(0)
+		mSize(0),
+		mIterationAlgorithm(eLPAlgorithm::BARRIER),
+		mSmoothing(0),
+		mMisprices(0),
+		mMaxAge(0),
+		mPartialPricing(false),
+		mCursor(0),
+		mPriced(0),
+		mSkipped(0),
+		mLooseTolerance(0),
+		mTolerance(0),
+		mPipelineThreads(0),
+		mInitialAdmitted(0),
+		mInitialLambda(0),
+		mB(6, std::vector<double>( 3, 0.0 ))
 	{
 	};
 	virtual ~CDLOSolver();
@@ -27,10 +67,64 @@ public:
 	};
 
 	std::vector<double> GetEdgeData();
+	const std::vector<sIterationStats>& GetIterationStats() { return mStats; };
+
+	// Prices against Alpha * best duals so far + (1 - Alpha) * current duals,
+	// 0 prices against the current duals only.  Only edges and candidates
+	// the current duals violate are admitted, an iteration where the
+	// smoothed duals violate none of them is counted as a misprice.
+	void SetDualSmoothing( double Alpha ) { mSmoothing = Alpha; };
+	double GetDualSmoothing() { return mSmoothing; };
+	int GetMisprices() { return mMisprices; };
+
+	// Removes an admitted edge from the LP once its plastic multipliers have
+	// been zero for MaxAge iterations, 0 keeps every admitted edge.  An edge
+	// is dropped at most kMaxDrops times, so the column generation still ends.
+	static constexpr int kMaxDrops = 2;
+	void SetColumnAging( int MaxAge ) { mMaxAge = MaxAge; };
+	int GetColumnAging() { return mMaxAge; };
+
+	// Scans the candidate edges from a rotating cursor and stops once enough
+	// strongly violated edges are found, only a full sweep without
+	// violations ends the solve.  Compact or streamed candidates are swept
+	// in full when the scan comes up short.  Not used together with dual
+	// smoothing.
+	void SetPartialPricing( bool Partial ) { mPartialPricing = Partial; };
+	bool GetPartialPricing() { return mPartialPricing; };
+
+	// Solves the early LPs to the Loose tolerance without crossover and
+	// tightens as the admissions and objective change shrink.  The final LP
+	// is always solved to full precision, 0 solves every LP tight.
+	void SetToleranceSchedule( double Loose ) { mLooseTolerance = Loose; };
+	double GetToleranceSchedule() { return mLooseTolerance; };
+
+	// Prices on Threads workers and starts the next LP as soon as enough
+	// strongly violated edges are queued, the rest of the sweep overlaps the
+	// LP and its violations are admitted with the next round.  Only a
+	// complete sweep of the current duals ends the solve.  0 prices in line,
+	// not combined with dual smoothing, partial pricing or column aging.
+	void SetPipelinedPricing( int Threads ) { mPipelineThreads = Threads; };
+	int GetPipelinedPricing() { return mPipelineThreads; };
+
+	// Nodal forces (the row duals of the node rows, node n at 3n - 3) of the
+	// last LP.  Forces set before Solve price one round at Lambda before the
+	// first LP, for example forces carried over from a coarser mesh.  Only
+	// used once, GetInitialAdmitted is the number of edges that round added.
+	const std::vector<double>& GetForces() { return mForces; };
+	void SetInitialForces( const std::vector<double>& Forces,
+						   double Lambda )
+	{
+		mInitialForces = Forces;
+		mInitialLambda = Lambda;
+	}
+	size_t GetInitialAdmitted() { return mInitialAdmitted; };
 	
 protected:
+	friend class CAutoDLOSolver;
+
 	CDomain* mDomain;
 	double* mResultArray;
+	std::vector<double> mResult;
 	size_t mSize;
 	size_t mNumDisp;
 	size_t mNumYEdges;
@@ -44,12 +138,102 @@ protected:
 	std::vector<double> mfL;
 	std::vector<double> mfD;
 
+	std::vector<sIterationStats> mStats;
+
+	// Admitted edges in mEdges order with the prefix offsets of their
+	// displacement columns (one per DOF) and plastic multiplier pairs, one
+	// entry more than there are edges
+	std::vector<CEdge*> mActiveEdges;
+	std::vector<size_t> mDOFOffsets;
+	std::vector<size_t> mYieldOffsets;
+
+	// Algorithm that produced the last LP solution, set by fSolve
+	eLPAlgorithm mIterationAlgorithm;
+
+	// Stability centre for the smoothed pricing: the duals with the best
+	// lower bound Lambda / max yield ratio
+	double mSmoothing;
+	int mMisprices;
+	std::vector<double> mCenter;
+	double mCenterLambda;
+	double mCenterBound;
+
+	int mMaxAge;
+
+	bool mPartialPricing;
+	size_t mCursor;
+	size_t mPriced;
+
+	// Groups of candidate edges whose yield ratio is bounded below 1 by the
+	// force spread of their node blocks are not priced, see CPricingBounds
+	CPricingBounds mBounds;
+	size_t mSkipped;
+
+	// Tolerance of the next LP, backends skip crossover while it is loose
+	double mLooseTolerance;
+	double mTolerance;
+
+	int mPipelineThreads;
+
+	std::vector<double> mForces;
+	std::vector<double> mInitialForces;
+	size_t mInitialAdmitted;
+	double mInitialLambda;
+
+	// Scratch of the current iteration, the row duals returned by fSolve
+	// live here until the next LP.  The lists below keep their capacity
+	// between iterations, so a warm solve loop does not allocate.
+	CIterationArena mArena;
+	std::vector<CEdge*> mNewEdges;
+	std::vector<CEdge*> mExpired;
+	std::vector<CEdge*> mMerged;
+	std::vector<std::vector<double>> mB;
+
+	// Compatibility matrix columns of the edges the backend adds next
+	CEdgeAssembly mAssembly;
+
+	// Returns the row duals, owned by mArena
 	virtual double* fSolve( double& Objective ) = 0;
 	virtual void fGetColumnSolution() = 0;
 	virtual bool fNewViolatedEdges( double Lambda,
 									double* rowDual );
-	void fCalculateNodalForces( std::map<size_t, std::array<double, 3>>& Forces,
-								double* rowDual );
+	double fGetYieldRatio( CEdge* Edge,
+						   double Lambda,
+						   const double* F1,
+						   const double* F2,
+						   std::vector<std::vector<double>>& B );
+	void fCalculateYieldRatio( CEdge* Edge,
+							   double Lambda,
+							   const double* Forces,
+							   std::vector<std::vector<double>>& B );
+	double fCalculateYieldRatios( double Lambda,
+								  double* rowDual );
+	void fPriceCandidates( double Lambda,
+						   double* rowDual,
+						   std::vector<CEdge*>& NewEdges );
+	size_t fGetAdmissionLimit();
+	bool fAdmitEdges( std::vector<CEdge*>& NewEdges );
+	bool fPricePartial( double Lambda,
+						double* rowDual );
+	bool fPriceSmoothed( double Lambda,
+						 double* rowDual );
+	void fAgeEdges( std::vector<CEdge*>& Expired );
+	double* fSolveIteration( double& Objective );
+	bool fPriceIteration( double Lambda,
+						  double* rowDual );
+	double fSolvePipelined();
+	bool fScheduleTolerance( double Old,
+							 double Objective,
+							 bool Solved,
+							 bool Violations );
+	bool fIsTight();
+	void fReserveIteration();
+	void fBuildBounds();
+	double* fResizeResult( size_t Size );
+
+	void fBuildActiveEdges();
+	void fUpdateActiveEdges( std::vector<CEdge*>& Admitted );
+	void fCalculateOffsets();
 
 	size_t fGetEdgeCount();
 	size_t fGetEdgeDOFCount();
@@ -4,6 +4,8 @@
 
 #include "Domain.h"
 
+#include "Constants.h"
+
 #ifdef SINGLE
 #define REAL float
 #else /* not SINGLE */
@@ -15,22 +17,30 @@
 #include "triangle.h"
 
 #include <assert.h>
+#include <atomic>
+#include <cstdint>
 #include <thread>
 #include <fstream>
 #include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+static std::mutex gTriangulateMutex;
 
 CDomain::CDomain():
 	mMpPosx( 1.0 ),
 	mMpNegx( 1.0 ),
 	mMpPosy( 1.0 ),
-	mMpNegy( 1.0 )
+	mMpNegy( 1.0 ),
+	mOrdering( eNodeOrdering::NONE ),
+	mThreads( 0 ),
+	mCompact( false ),
+	mBudget( 0 )
 {
-	CEdge::SetNodes( &mNodes );
 }
 
 CDomain::~CDomain()
 {
-	CEdge::SetNodes( nullptr );
 }
 
 void 
@@ -99,6 +109,7 @@ CDomain::fAddEdge( size_t N1, size_t N2,
 	double d = (mNodes[N1 - 1].Point - mNodes[N2 - 1].Point).Length();
 	Edges.push_back(
 		{ 
+			&mNodes,
 			N1,
 			N2,
 			Type,
@@ -112,37 +123,75 @@ CDomain::fAddEdge( size_t N1, size_t N2,
 }
 
 void 
-CDomain::fTesselate( double Size )
+CDomain::fTesselateLine( const CPoint2D& p1,
+						 const CPoint2D& p2,
+						 eEdgeType Type,
+						 double Size )
 {
-	CVector2D v;
-	std::vector<CEdge> NewEdges;
+	CVector2D v = p2 - p1;
+	double Length = v.Length();
+	v.Normalize();
+
+	int Number = std::max( static_cast<int>(floor( Length / (Size / 2) + 0.5 )), 1 );
+	double Spacing = Length / Number;
 
+	size_t N1 = fAddNode( p1 );
+
+	for ( int j = 0; j < Number; ++j )
+	{
+		size_t N2 = fAddNode( p1 + v*(j + 1)*Spacing );
+		fAddEdge( N1, N2, Type, mBoundaryEdges );
+		N1 = N2;
+	}
+}
+
+void 
+CDomain::fTesselate( double Size )
+{
 	std::vector<CPoint2D> Points = mPoly.GetPoints();
 	Points.push_back( Points.front() );
 
 	for ( size_t i = 1; i < Points.size(); ++i )
+		fTesselateLine( Points[i - 1], Points[i], mPoly.GetEdgeType( i - 1 ), Size );
+
+	// Openings are free edges, supports keep their type.  Both become
+	// segments of the mesh.
+	for ( auto& Opening : mOpenings )
 	{
-		const CPoint2D p1 = Points[i - 1];
-		const CPoint2D p2 = Points[i];
+		Points = Opening.GetPoints();
+		Points.push_back( Points.front() );
+
+		for ( size_t i = 1; i < Points.size(); ++i )
+			fTesselateLine( Points[i - 1], Points[i], eEdgeType::FREE, Size );
+	}
 
-		eEdgeType Type = mPoly.GetEdgeType( i - 1 );
-				
-		v = p2 - p1;
-		double Length = v.Length();
-		v.Normalize();
+	for ( const auto& Support : mSupports )
+		fTesselateLine( Support.mLine.P1(), Support.mLine.P2(), Support.Type, Size );
+}
 
-		int Number = static_cast<int>(floor( Length / (Size / 2) + 0.5 ));
-		double Spacing = Length / Number;
+CPoint2D
+CDomain::fGetHolePoint( const CPoly2D& Opening )
+{
+	// Just inside the first edge whose midpoint can be stepped into the
+	// opening, the centroid of a concave opening may lie outside it
+	size_t Count = Opening.GetNumPoints();
 
-		size_t N1 = fAddNode( p1 );
+	for ( size_t i = 0; i < Count; ++i )
+	{
+		const CPoint2D& p1 = Opening.GetPoint( i );
+		const CPoint2D& p2 = Opening.GetPoint( (i + 1) % Count );
 
-		for ( int j = 0; j < Number; ++j )
-		{
-			size_t N2 = fAddNode( p1 + v*(j + 1)*Spacing );
-			fAddEdge( N1, N2, Type, mBoundaryEdges );
-			N1 = N2;
-		}
+		CPoint2D Mid = (p1 + p2) / 2;
+		CVector2D Normal( p1.y - p2.y, p2.x - p1.x );
+		Normal = Normal * 1e-3;
+
+		if ( Opening.PointInPoly( Mid + Normal ) )
+			return Mid + Normal;
+		if ( Opening.PointInPoly( Mid - Normal ) )
+			return Mid - Normal;
 	}
+
+	return Opening.Centroid();
 }
 
 void 
@@ -180,9 +229,18 @@ CDomain::fCreateNodes( double Size )
 	}
 
 	Input.numberofregions = 0;
-	Input.numberofholes = 0;
 
-	Input.holelist = 0;
+	// Triangle carves the openings out from a point inside each
+	std::vector<double> Holes;
+	for ( const auto& Opening : mOpenings )
+	{
+		CPoint2D Point = fGetHolePoint( Opening );
+		Holes.push_back( Point.x );
+		Holes.push_back( Point.y );
+	}
+
+	Input.numberofholes = static_cast<int>(mOpenings.size());
+	Input.holelist = Holes.empty() ? nullptr : &Holes[0];
 
 	Input.numberofsegments = (int)(mBoundaryEdges.size());
 
@@ -250,6 +308,10 @@ CDomain::fCreateNodes( double Size )
 	//-n : Outputs neighbours
 	//-Q : Quiet
 
+	// Triangle keeps its arithmetic state in globals, domains are meshed
+	// one at a time
+	std::lock_guard<std::mutex> Lock( gTriangulateMutex );
+
 	triangulate( "pzAYYevnV", &Input, &mid, &vorout );
 
 	/* Attach area constraints to the triangles in preparation for */
@@ -316,13 +378,16 @@ CDomain::fCreateNodes( double Size )
 	triangulate( "pYYrzaneV", &mid, &out, nullptr );
 	triangulate( "pYYzaPneqV", &out, &final, nullptr );
 
+	// Node of every mesh point, every point is the end of an edge
+	std::vector<size_t> PointNode( final.numberofpoints, 0 );
+
 	for ( int i = 0; i<final.numberofedges; i++ )
 	{
 		size_t N1 = static_cast<size_t>(final.edgelist[2 * i]);
-		N1 = fAddNode( { final.pointlist[2 * N1], final.pointlist[2 * N1 + 1] } );
+		N1 = PointNode[N1] = fAddNode( { final.pointlist[2 * N1], final.pointlist[2 * N1 + 1] } );
 
 		size_t N2 = static_cast<size_t>(final.edgelist[2 * i + 1]);
-		N2 = fAddNode( { final.pointlist[2 * N2], final.pointlist[2 * N2 + 1] } );
+		N2 = PointNode[N2] = fAddNode( { final.pointlist[2 * N2], final.pointlist[2 * N2 + 1] } );
 
 		if ( final.edgemarkerlist[i] == 0 )
 		{
@@ -336,6 +401,13 @@ CDomain::fCreateNodes( double Size )
 			}
 		}
 	}
+
+	for ( int i = 0; i < final.numberoftriangles; i++ )
+	{
+		mTriangles.push_back( { PointNode[final.trianglelist[3 * i]],
+								PointNode[final.trianglelist[3 * i + 1]],
+								PointNode[final.trianglelist[3 * i + 2]] } );
+	}
 }
 
 bool 
@@ -368,14 +440,201 @@ CDomain::Discretize( double Size )
 	mMeshEdges.clear();
 	mAdditionalEdges.clear();
 	mEdges.clear();
+	mCandidates.clear();
+	mCompactEdges.clear();
+	mMaterialized.clear();
+	mPool.Close();
+	mLoads.Clear();
+	mNodeMap.clear();
+	mTriangles.clear();
 
 	fTesselate( Size );
 	fCreateNodes( Size );
+	fReorderNodes();
+}
+
+void
+CDomain::fOrderHilbert( std::vector<size_t>& Order )
+{
+	const uint32_t kSide = 1 << 16;
+
+	double MinX = DBL_MAX, MinY = DBL_MAX;
+	double MaxX = -DBL_MAX, MaxY = -DBL_MAX;
+
+	for ( auto& Node : mNodes )
+	{
+		MinX = std::min( MinX, Node.Point.x );
+		MinY = std::min( MinY, Node.Point.y );
+		MaxX = std::max( MaxX, Node.Point.x );
+		MaxY = std::max( MaxY, Node.Point.y );
+	}
+
+	double Scale = (kSide - 1) / std::max( std::max( MaxX - MinX, MaxY - MinY ), EPSILON );
+
+	std::vector<std::pair<uint64_t, size_t>> Keys;
+	Keys.reserve( mNodes.size() );
+
+	for ( auto& Node : mNodes )
+	{
+		uint32_t x = static_cast<uint32_t>((Node.Point.x - MinX) * Scale);
+		uint32_t y = static_cast<uint32_t>((Node.Point.y - MinY) * Scale);
+		uint64_t d = 0;
+
+		// Distance along the curve, rotating each quadrant into place
+		for ( uint32_t s = kSide / 2; s > 0; s /= 2 )
+		{
+			uint32_t rx = (x & s) > 0;
+			uint32_t ry = (y & s) > 0;
+
+			d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+			if ( ry == 0 )
+			{
+				if ( rx == 1 )
+				{
+					x = kSide - 1 - x;
+					y = kSide - 1 - y;
+				}
+				std::swap( x, y );
+			}
+		}
+
+		Keys.push_back( { d, Node.ID } );
+	}
+
+	std::sort( Keys.begin(), Keys.end() );
+
+	Order.clear();
+	for ( auto& Key : Keys )
+		Order.push_back( Key.second );
+}
+
+void
+CDomain::fOrderCuthillMcKee( std::vector<size_t>& Order )
+{
+	// Mesh graph: the boundary segments and the triangle edges
+	std::vector<std::vector<size_t>> Adjacent( mNodes.size() + 1 );
+
+	for ( auto Edges : { &mBoundaryEdges, &mMeshEdges } )
+	{
+		for ( auto& Edge : *Edges )
+		{
+			Adjacent[Edge.N1].push_back( Edge.N2 );
+			Adjacent[Edge.N2].push_back( Edge.N1 );
+		}
+	}
+
+	auto ByDegree = [&]( size_t l, size_t r ) -> bool
+	{
+		return Adjacent[l].size() < Adjacent[r].size();
+	};
+
+	std::vector<size_t> Nodes;
+	for ( size_t i = 1; i <= mNodes.size(); ++i )
+		Nodes.push_back( i );
+
+	std::stable_sort( Nodes.begin(), Nodes.end(), ByDegree );
+
+	std::vector<bool> Visited( mNodes.size() + 1, false );
+	std::vector<size_t> Next;
+
+	Order.clear();
+
+	// Breadth first from a node of least degree, once per component
+	for ( auto Start : Nodes )
+	{
+		if ( Visited[Start] )
+			continue;
+
+		size_t Head = Order.size();
+		Order.push_back( Start );
+		Visited[Start] = true;
+
+		while ( Head < Order.size() )
+		{
+			size_t Node = Order[Head++];
+
+			Next.clear();
+			for ( auto k : Adjacent[Node] )
+			{
+				if ( !Visited[k] )
+				{
+					Visited[k] = true;
+					Next.push_back( k );
+				}
+			}
+
+			std::stable_sort( Next.begin(), Next.end(), ByDegree );
+			Order.insert( Order.end(), Next.begin(), Next.end() );
+		}
+	}
+
+	std::reverse( Order.begin(), Order.end() );
+}
+
+void
+CDomain::fReorderNodes()
+{
+	if ( mOrdering == eNodeOrdering::NONE || mNodes.empty() )
+		return;
+
+	// Order[i] is the current ID of the node that becomes node i + 1
+	std::vector<size_t> Order;
+
+	if ( mOrdering == eNodeOrdering::HILBERT )
+		fOrderHilbert( Order );
+	else
+		fOrderCuthillMcKee( Order );
+
+	std::vector<size_t> NewID( mNodes.size() + 1, 0 );
+	std::vector<CNode> Nodes( mNodes.size() );
+
+	for ( size_t i = 0; i < Order.size(); ++i )
+	{
+		NewID[Order[i]] = i + 1;
+		Nodes[i] = { mNodes[Order[i] - 1].Point, i + 1 };
+	}
+
+	// Swap the contents, the edges keep a pointer to mNodes
+	mNodes.swap( Nodes );
+
+	for ( auto Edges : { &mBoundaryEdges, &mMeshEdges } )
+	{
+		for ( auto& Edge : *Edges )
+		{
+			Edge.N1 = NewID[Edge.N1];
+			Edge.N2 = NewID[Edge.N2];
+		}
+	}
+
+	for ( auto& Triangle : mTriangles )
+	{
+		for ( auto& Node : Triangle )
+			Node = NewID[Node];
+	}
+
+	std::map<size_t, std::vector<size_t>> NodeMap;
+	for ( auto& Entry : mNodeMap )
+	{
+		auto& Adjacent = NodeMap[NewID[Entry.first]];
+		for ( auto k : Entry.second )
+			Adjacent.push_back( NewID[k] );
+	}
+
+	mNodeMap.swap( NodeMap );
 }
 
 void 
 CDomain::BuildEdges()
 {
+	std::vector<CLine2D> Supports;
+	for ( const auto& Support : mSupports )
+		Supports.push_back( Support.mLine );
+
+	mBoundaryIndex.Build( mPoly, mOpenings, Supports );
+	mLoads.SetOpenings( mOpenings );
+	mLoads.ClearCandidates();
+
 	for ( size_t k = 0; k < mBoundaryEdges.size(); ++k )
 	{
 		bool Skip = false;
@@ -391,22 +650,6 @@ CDomain::BuildEdges()
 			assert( 0 );
 	}
 
-	for ( int i = 0; i < mNodes.size(); ++i )
-	{
-		for ( int j = i + 1; j < mNodes.size(); ++j )
-		{
-			if ( !fEdgeAdded( i + 1, j + 1 ) )
-			{
-				mNodeMap[i + 1].push_back( j + 1 );
-				mNodeMap[j + 1].push_back( i + 1 );
-
-				fAddEdge( mNodes[i].ID, mNodes[j].ID, eEdgeType::INTERNAL, mAdditionalEdges );
-				mAdditionalEdges.back().Removeable = true;
-			}
-		}
-	}/**/
-
-	mEdges.reserve( mMeshEdges.size() + mBoundaryEdges.size() + mAdditionalEdges.size() );
 	for ( size_t i = 0; i < mBoundaryEdges.size(); ++i )
 	{
 		mBoundaryEdges[i].Added = true;
@@ -417,232 +660,403 @@ CDomain::BuildEdges()
 		mMeshEdges[i].Added = true;
 		mEdges.push_back( &mMeshEdges[i] );
 	}
-	for ( size_t i = 0; i < mAdditionalEdges.size(); ++i )
+
+	// The candidates go to their final blocks in one parallel pass, the
+	// streamed candidates are generated with the pool instead
+	mAdditionalEdges.clear();
+	if ( mBudget == 0 )
 	{
-		mEdges.push_back( &mAdditionalEdges[i] );
+		fGenerateCandidates( 1, mNodes.size() + 1, mAdditionalEdges, mEdges );
+
+		size_t Count = mEdges.size();
+		for ( auto& Block : mAdditionalEdges )
+			Count += Block.size();
+
+		mEdges.reserve( Count );
+		for ( auto& Block : mAdditionalEdges )
+		{
+			for ( auto& Edge : Block )
+				mEdges.push_back( &Edge );
+		}
 	}
 
-	fRemoveOverlappedEdges( mEdges );
-	fRemoveExteriorEdges( mEdges, mPoly );
+	// Columns follow the node numbering, so an edge's entries land near the
+	// rows of its neighbours
+	if ( mOrdering != eNodeOrdering::NONE )
+	{
+		std::stable_sort( mEdges.begin(), mEdges.end(), []( const CEdge* l, const CEdge* r ) -> bool
+		{
+			size_t l1 = std::min( l->N1, l->N2 ), l2 = std::max( l->N1, l->N2 );
+			size_t r1 = std::min( r->N1, r->N2 ), r2 = std::max( r->N1, r->N2 );
 
+			return l1 < r1 || (l1 == r1 && l2 < r2);
+		} );
+	}
 
-	size_t Count = mEdges.size() / 4;
+	if ( mBudget > 0 )
+		fStreamCandidates();
+	else if ( mCompact )
+		fCompactCandidates();
 
-	size_t Start1 = 0;
-	size_t End1 = Count;
+	// The load table rows follow mEdges
+	for ( size_t i = 0; i < mEdges.size(); ++i )
+		mEdges[i]->Position = i;
 
-	size_t Start2 = End1;
-	size_t End2 = Start2 + Count;
+	mLoads.Calculate( mEdges, mPoly );
+}
 
-	size_t Start3 = End2;
-	size_t End3 = Start3 + Count;
+sCandidateEdge
+CDomain::fCompactEdge( CEdge* Edge )
+{
+	std::array<double, 3> UDLVector;
 
-	size_t Start4 = End3;
-	size_t End4 = mEdges.size();
+	CVector2D v = (Edge->GetPoint( 1 ) - Edge->GetPoint( 0 )) / Edge->Length;
+	Edge->GetUDLLoadVector( UDLVector, mPoly );
 
-	std::thread T1( [&]() { fCalulculateUDLFactors( mEdges, Start1, End1 ); } );
-	std::thread T2( [&]() { fCalulculateUDLFactors( mEdges, Start2, End2 ); } );
-	std::thread T3( [&]() { fCalulculateUDLFactors( mEdges, Start3, End3 ); } );
-	std::thread T4( [&]() { fCalulculateUDLFactors( mEdges, Start4, End4 ); } );
+	sCandidateEdge Result;
+	Result.N1 = static_cast<uint32_t>(Edge->N1);
+	Result.N2 = static_cast<uint32_t>(Edge->N2);
+	Result.c = static_cast<float>(v.x);
+	Result.s = static_cast<float>(v.y);
+	Result.Length = static_cast<float>(Edge->Length);
+	Result.UDL = static_cast<float>(UDLVector[0]);
+	Result.MpPos = static_cast<float>(Edge->MpPos);
+	Result.MpNeg = static_cast<float>(Edge->MpNeg);
 
-	T1.join();
-	T2.join();
-	T3.join();
-	T4.join();
+	return Result;
 }
 
 void
-CDomain::fCalulculateUDLFactors( std::vector<CEdge*>& Edges,
-								 size_t Start,
-								 size_t End )
+CDomain::fAddNearestEdges( size_t Node,
+						   std::vector<CEdge>& Edges )
 {
-	std::array<double, 3> EdgefL;
+	struct sRay
+	{
+		double Angle;
+		double Distance;
+		size_t Node;
+	};
 
-	for ( size_t i = Start; i < End; ++i )
-		Edges[i]->GetUDLLoadVector( EdgefL, mPoly );
-}
+	const CPoint2D& Point = mNodes[Node - 1].Point;
+	std::array<double, 3> UDLVector;
 
-void 
-CDomain::fMoveToEndOfPartition( std::vector<CEdge*>& Edges,
-								size_t& End )
-{
-	size_t i = End;
+	std::vector<sRay> Rays;
+	Rays.reserve( mNodes.size() );
 
-	while ( i < Edges.size() &&
-			abs( Edges[i - 1]->Line.Slope() - Edges[i]->Line.Slope() ) < 1e-9 )
+	for ( size_t k = 1; k <= mNodes.size(); ++k )
 	{
-		++i;
+		if ( k == Node )
+			continue;
+
+		CVector2D v = mNodes[k - 1].Point - Point;
+
+		double Angle = atan2( v.y, v.x );
+		if ( Angle <= -PI + 1e-12 )
+			Angle = PI;
+
+		Rays.push_back( { Angle, v.LengthSquared(), k } );
+	}
+
+	std::sort( Rays.begin(), Rays.end(), []( const sRay& l, const sRay& r ) -> bool
+	{
+		return l.Angle < r.Angle || (l.Angle == r.Angle && l.Distance < r.Distance);
+	} );
+
+	std::vector<size_t> Others;
+	std::vector<double> x, y;
+
+	size_t i = 0;
+	while ( i < Rays.size() )
+	{
+		// Collinear nodes in the same direction, the nearest one wins
+		size_t Nearest = i;
+		size_t j = i + 1;
+
+		while ( j < Rays.size() && Rays[j].Angle - Rays[i].Angle < 1e-9 )
+		{
+			if ( Rays[j].Distance < Rays[Nearest].Distance )
+				Nearest = j;
+			++j;
+		}
+
+		size_t Other = Rays[Nearest].Node;
+
+		// Each pair once, from its lower node
+		if ( Other > Node && !fEdgeAdded( Node, Other ) )
+		{
+			Others.push_back( Other );
+			x.push_back( mNodes[Other - 1].Point.x );
+			y.push_back( mNodes[Other - 1].Point.y );
+		}
+
+		i = j;
 	}
 
-	End = i;
+	// All edges of the node against the boundary in one batch
+	std::vector<double> Mid( 2 * Others.size() );
+	std::vector<uint64_t> Inside( CPoly2D::MaskWords( Others.size() ) );
+
+	mBoundaryIndex.IsInside( Point, x.data(), y.data(), Others.size(), Mid.data(), Inside.data() );
+
+	for ( size_t k = 0; k < Others.size(); ++k )
+	{
+		if ( !(Inside[k / 64] >> (k % 64) & 1) )
+			continue;
+
+		fAddEdge( Node, Others[k], eEdgeType::INTERNAL, Edges );
+		Edges.back().Removeable = true;
+		Edges.back().GetUDLLoadVector( UDLVector, mPoly );
+	}
 }
 
 void
-CDomain::fOverlapInternal( std::vector<CEdge*>& Edges,
-						   size_t Start,
-						   size_t End )
+CDomain::fStreamCandidates()
 {
-	std::vector<CPoint2D> Intersections;
+	// A block of nodes keeps its edges in memory until the UDL and load
+	// factors are calculated, it is sized so the block stays within the
+	// budget.  The load factors go to the pool with the records.
+	size_t LoadWidth = mLoads.GetCount();
+	size_t NodeCount = mNodes.size();
+	size_t PerEdge = sizeof( CEdge ) + sizeof( CEdge* ) + sizeof( sCandidateEdge ) + LoadWidth * (3 * sizeof( double ) + sizeof( float ));
+	size_t PerNode = std::max<size_t>( NodeCount, 1 ) * PerEdge;
+
+	if ( mBudget < std::max( PerNode, CCandidatePool::GetMinimumBudget() ) )
+		throw std::runtime_error( "Candidate budget too small for one block of nodes" );
+
+	if ( !mPool.Open( mPoolFile, mBudget, LoadWidth ) )
+		throw std::runtime_error( "Can not create the candidate pool \"" + mPoolFile + "\"" );
+
+	size_t BlockNodes = mBudget / PerNode;
+
+	std::vector<std::vector<CEdge>> Blocks;
+	std::vector<sCandidateEdge> Records;
+	std::vector<float> Loads;
+	std::vector<CEdge*> None, Streamed;
 
-	for ( size_t i = Start; i < End; ++i )
+	for ( size_t Begin = 1; Begin <= NodeCount; Begin += BlockNodes )
 	{
-		CEdge* EdgeI = Edges[i];
-		const CLine2D& LineI = EdgeI->Line;
-		const CPoint2D& MaxI = LineI.Max();
-		const CPoint2D& MinI = LineI.Min();
+		size_t End = std::min( Begin + BlockNodes, NodeCount + 1 );
 
-		if ( !EdgeI->Delete )
+		// The boundary and mesh edges get their UDL factors with the first block
+		fGenerateCandidates( Begin, End, Blocks, Begin == 1 ? mEdges : None );
+
+		Records.clear();
+		Streamed.clear();
+		for ( auto& Block : Blocks )
 		{
-			for ( size_t j = i + 1; j < End; ++j )
+			for ( auto& Edge : Block )
 			{
-				CEdge* EdgeJ = Edges[j];
-				const CLine2D& LineJ = EdgeJ->Line;
-				const CPoint2D& MaxJ = LineJ.Max();
-				const CPoint2D& MinJ = LineJ.Min();
+				Records.push_back( fCompactEdge( &Edge ) );
+				Streamed.push_back( &Edge );
+			}
+		}
 
-				if ( abs( LineI.Slope() - LineJ.Slope() ) > 1e-9 )
-				{
-					break;
-				}
+		mLoads.GetCandidateFactors( Streamed, mPoly, Loads );
 
-				if ( !EdgeJ->Delete )
-				{
-					bool skip = MaxJ.x < MinI.x;
-					skip |= MinJ.x > MaxI.x;
-					skip |= MaxJ.y < MinI.y;
-					skip |= MinJ.y > MaxI.y;
-					skip |= !Colinear( LineI, LineJ );
-					if ( !skip )
-					{
-						Intersect( LineI, LineJ, Intersections );
-						if ( Intersections.size() > 1 )  //Overlap
-						{
-							if ( EdgeI->Length > EdgeJ->Length && !EdgeI->Delete )
-							{
-								EdgeI->Delete = true;
-								break;
-							}
-							else
-							{
-								EdgeJ->Delete = true;
-							}
-						}
-					}
-				}
-			}
+		if ( !mPool.Append( Records, Loads ) )
+		{
+			mPool.Close();
+			throw std::runtime_error( "Writing the candidate pool \"" + mPoolFile + "\" failed" );
 		}
 	}
 }
 
-void 
-CDomain::fRemoveOverlappedEdges( std::vector<CEdge*>& Edges )
+void
+CDomain::fGenerateCandidates( size_t Begin,
+							  size_t End,
+							  std::vector<std::vector<CEdge>>& Blocks,
+							  const std::vector<CEdge*>& Fixed )
 {
-	std::sort( Edges.begin(), Edges.end(), []( const CEdge* l, const CEdge* r ) -> bool
+	// Every node decides its own edges: the nearest node along each
+	// direction, not yet joined and not outside the outline, with the UDL
+	// factors calculated straight away.  Chunks of nodes write to their own
+	// block, so the edge order does not depend on the threads.
+	const size_t kChunk = 64;
+
+	size_t Chunks = (End - Begin + kChunk - 1) / kChunk;
+	size_t FixedChunks = (Fixed.size() + kChunk - 1) / kChunk;
+	std::atomic<size_t> Next( 0 );
+
+	Blocks.clear();
+	Blocks.resize( Chunks );
+
+	auto Work = [&]()
 	{
-		return l->Line.Slope() < r->Line.Slope();
-	} );
+		for ( ;; )
+		{
+			size_t Chunk = Next++;
+			if ( Chunk >= Chunks + FixedChunks )
+				break;
 
-	size_t Count = Edges.size() / 4;
+			// The given fixed edges only need their UDL factors
+			if ( Chunk >= Chunks )
+			{
+				std::array<double, 3> UDLVector;
 
-	size_t Start1 = 0;
-	size_t End1 = Count;
+				size_t First = (Chunk - Chunks) * kChunk;
+				for ( size_t i = First; i < std::min( First + kChunk, Fixed.size() ); ++i )
+					Fixed[i]->GetUDLLoadVector( UDLVector, mPoly );
 
-	fMoveToEndOfPartition( Edges, End1 );
+				continue;
+			}
 
-	size_t Start2 = End1;
-	size_t End2 = Start2 + Count;
+			size_t Last = std::min( Begin + (Chunk + 1) * kChunk, End );
+			for ( size_t i = Begin + Chunk * kChunk; i < Last; ++i )
+				fAddNearestEdges( i, Blocks[Chunk] );
+		}
+	};
 
-	fMoveToEndOfPartition( Edges, End2 );
+	unsigned Threads = mThreads > 0 ? static_cast<unsigned>(mThreads) : std::max( std::thread::hardware_concurrency(), 1u );
 
-	size_t Start3 = End2;
-	size_t End3 = Start3 + Count;
+	std::vector<std::thread> Workers;
+	for ( unsigned i = 1; i < Threads; ++i )
+		Workers.push_back( std::thread( Work ) );
 
-	fMoveToEndOfPartition( Edges, End3 );
+	Work();
 
-	size_t Start4 = End3;
-	size_t End4 = Edges.size();
+	for ( auto& Worker : Workers )
+		Worker.join();
+}
 
-	std::thread T1( [&]() { fOverlapInternal( Edges, Start1, End1 ); } );
-	std::thread T2( [&]() { fOverlapInternal( Edges, Start2, End2 ); } );
-	std::thread T3( [&]() { fOverlapInternal( Edges, Start3, End3 ); } );
-	std::thread T4( [&]() { fOverlapInternal( Edges, Start4, End4 ); } );
+size_t
+CDomain::fGetCandidateCount()
+{
+	return mPool.IsOpen() ? mPool.Size() : mCandidates.size();
+}
 
-	T1.join();
-	T2.join();
-	T3.join();
-	T4.join();
+void
+CDomain::fCompactCandidates()
+{
+	std::vector<CEdge*> Edges;
 
-	Count = 0;
-	for ( size_t i = Edges.size(); i >= 1; --i )
+	mCandidates.clear();
+
+	std::vector<CEdge*> Compacted;
+
+	for ( auto Edge : mEdges )
 	{
-		if ( Edges[i - 1]->Delete )
+		if ( !Edge->Removeable || Edge->Added )
+			Edges.push_back( Edge );
+		else
 		{
-			++Count;
-			Edges.erase( Edges.begin() + i - 1 );
+			mCandidates.push_back( fCompactEdge( Edge ) );
+			Compacted.push_back( Edge );
 		}
 	}
+
+	mLoads.AppendCandidates( Compacted, mPoly );
+
+	mCandidates.shrink_to_fit();
+
+	// The boundary and mesh edges live in their own vectors, only the
+	// additional edges are released
+	mEdges.swap( Edges );
+	mEdges.shrink_to_fit();
+
+	std::vector<std::vector<CEdge>>().swap( mAdditionalEdges );
 }
 
-void 
-CDomain::fRemoveExteriorEdges( std::vector<CEdge*>& Edges,
-							   const CPoly2D& Poly )
+size_t
+CDomain::AddCandidates( const std::function<bool( size_t N1, size_t N2 )>& Select )
 {
-	CPoint2D p;
-	std::vector<CPoint2D> Intersections;
+	size_t Result = 0;
 
-	for ( size_t i = 0; i < Edges.size(); ++i )
+	auto Visit = [&]( const sCandidateEdge* Candidates, const float*, size_t Count, size_t First )
 	{
-		if ( Edges[i]->Removeable )
+		for ( size_t i = 0; i < Count; ++i )
 		{
+			const sCandidateEdge& Candidate = Candidates[i];
 
-			Intersections.clear();
-			Poly.GetOrderedIntersections( Edges[i]->Line, Intersections );
+			if ( !Select( Candidate.N1, Candidate.N2 ) ||
+				 std::binary_search( mMaterialized.begin(), mMaterialized.end(), First + i ) )
+				continue;
 
-			for ( size_t j = 0; j < Intersections.size() - 1; ++j )
-			{
-				p = (Intersections[j] + Intersections[j + 1]) / 2;
-				if ( Poly.PointOnPoly( p ) == -1 && !Poly.PointInPoly( p ) )
-				{
-					Edges[i]->Delete = true;
-					break;
-				}
-			}
+			fMaterialize( First + i, Candidate )->Added = true;
+			++Result;
 		}
-	}
+	};
 
-	size_t Count = 0;
-	for ( size_t i = Edges.size(); i >= 1; --i )
+	if ( mPool.IsOpen() )
 	{
-		if ( Edges[i - 1]->Delete )
+		if ( !mPool.ForEach( Visit ) )
+			throw std::runtime_error( "Mapping the candidate pool failed" );
+	}
+	else if ( !mCandidates.empty() )
+		Visit( &mCandidates[0], nullptr, mCandidates.size(), 0 );
+
+	return Result;
+}
+
+CEdge*
+CDomain::fMaterialize( size_t Index,
+					   const sCandidateEdge& Candidate )
+{
+	// Exact geometry and moments from the nodes, not the stored floats
+	double d = (mNodes[Candidate.N1 - 1].Point - mNodes[Candidate.N2 - 1].Point).Length();
+	mCompactEdges.push_back(
 		{
-			++Count;
-			Edges.erase( Edges.begin() + i - 1 );
+			&mNodes,
+			Candidate.N1,
+			Candidate.N2,
+			eEdgeType::INTERNAL,
+			d,
+			mMpPosx,
+			mMpNegx,
+			mMpPosy,
+			mMpNegy
 		}
-	}
+	);
+
+	CEdge* Edge = &mCompactEdges.back();
+	Edge->Removeable = true;
+	Edge->Position = mEdges.size();
+
+	mEdges.push_back( Edge );
+	mLoads.Append( Edge, mPoly );
+	mMaterialized.insert( std::lower_bound( mMaterialized.begin(), mMaterialized.end(), Index ), Index );
+
+	return Edge;
 }
 
 void 
-CDomain::fCalculateUDL( std::vector<double>& LoadVector,
-						double UDL )
+CDomain::fCalculateLoads( const std::vector<CEdge*>& Edges,
+						  std::vector<double>& Live,
+						  std::vector<double>& Dead )
 {
+	// Live and dead together, one pass over the edges
 	size_t Index = 0;
 
-	std::array<double, 3> UDLVector;
-	for ( size_t i = 0; i < mEdges.size(); ++i )
+	std::array<double, 3> LiveVector, DeadVector;
+	for ( auto Edge : Edges )
 	{
-		if ( mEdges[i]->Added )
-		{
-			mEdges[i]->GetUDLLoadVector( UDLVector, mPoly );
+		fGetLoadVector( Edge, LiveVector, DeadVector );
 
-			for ( size_t j = 0; j < mEdges[i]->DOF(); ++j )
-			{
-				LoadVector[Index] += UDL*UDLVector[j];
-				++Index;
-			}
+		for ( size_t j = 0; j < Edge->DOF(); ++j )
+		{
+			Live[Index] += LiveVector[j];
+			Dead[Index] += DeadVector[j];
+			++Index;
 		}
 	}
 }
 
+void
+CDomain::fGetLoadVector( CEdge* Edge,
+						 std::array<double, 3>& Live,
+						 std::array<double, 3>& Dead )
+{
+	std::array<double, 3> UDLVector;
+	Edge->GetUDLLoadVector( UDLVector, mPoly );
+
+	for ( size_t j = 0; j < 3; ++j )
+	{
+		Live[j] = mLiveLoad * UDLVector[j];
+		Dead[j] = mDeadLoad * UDLVector[j];
+	}
+
+	mLoads.Combine( Edge->Position, &Live[0], &Dead[0] );
+}
+
 void
 CDomain::Save( const std::string& File )
 {
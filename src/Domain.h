@@ -12,7 +12,13 @@
 #include "Edge.h"
 
 #include "Enums.h"
+#include "CandidatePool.h"
+#include "BoundaryIndex.h"
+#include "LoadTable.h"
 
+#include <array>
+#include <deque>
+#include <functional>
 #include <map>
 #include <string>
 
@@ -21,6 +27,8 @@ class CDomain
 	friend class CDLOSolver;
 	friend class CMosekDLOSolver;
 	friend class CCoinDLOSolver;
+	friend class CHighsDLOSolver;
+	friend class CAutoDLOSolver;
 public:
 	CDomain();
 	virtual ~CDomain();
@@ -33,6 +41,47 @@ public:
 					 const CPoint2D& P2,
 					 eEdgeType Type );
 
+	// Renumbers the nodes after Discretize and sorts the edges by their
+	// nodes, so LP rows and columns of neighbouring nodes sit together
+	void SetNodeOrdering( eNodeOrdering Ordering ) { mOrdering = Ordering; };
+	eNodeOrdering GetNodeOrdering() { return mOrdering; };
+
+	// Keeps the removeable candidate edges as sCandidateEdge records after
+	// BuildEdges, mEdges then only holds the boundary, mesh and materialized
+	// edges.  Set before BuildEdges.
+	void SetCompactCandidates( bool Compact ) { mCompact = Compact; };
+	bool GetCompactCandidates() { return mCompact; };
+
+	// Streams the candidate edges into File in blocks instead of building
+	// them in memory, pricing maps them back in windows of at most Bytes.
+	// Along every direction from a node only the nearest node gets an edge,
+	// longer collinear edges would overlap it.  0 keeps them in memory.
+	// BuildEdges throws std::runtime_error when the budget is smaller than
+	// one block of nodes or the file can not be written.
+	void SetCandidateBudget( size_t Bytes,
+							 const std::string& File )
+	{
+		mBudget = Bytes;
+		mPoolFile = File;
+	}
+	size_t GetCandidateBudget() { return mBudget; };
+	const std::string& GetCandidateFile() { return mPoolFile; };
+	double GetCandidateIOTime() { return mPool.GetIOTime(); };
+
+	// Builds the compact or streamed candidates that Select picks by their
+	// node IDs and adds them to the first LP, returns how many.  The edges
+	// in GetEdges are not visited.
+	size_t AddCandidates( const std::function<bool( size_t N1, size_t N2 )>& Select );
+
+	// Threads building the candidate edges and their load rows, 0 uses a
+	// thread per hardware thread
+	void SetThreads( int Threads )
+	{
+		mThreads = Threads;
+		mLoads.SetThreads( Threads );
+	}
+	int GetThreads() { return mThreads; };
+
 	void Discretize( double Size );
 	void BuildEdges();
 
@@ -41,6 +90,38 @@ public:
 	{
 		mLiveLoad = Live;
 		mDeadLoad = Dead;
+		mLoads.SetPlateLoad( Live, Dead );
+	}
+
+	// Loads besides the plate UDL, added before BuildEdges (afterwards they
+	// throw std::runtime_error until the next Discretize).  An area load
+	// acts on a region of the plate and a line load per unit length, live
+	// loads are scaled by the load factor.  Returns the index for SetLoad,
+	// which only changes the magnitudes.
+	size_t AddAreaLoad( const std::vector<CPoint2D>& Region,
+						double Live,
+						double Dead )
+	{
+		return mLoads.Add( eLoadType::AREA, Region, Live, Dead );
+	}
+	size_t AddPointLoad( const CPoint2D& Point,
+						 double Live,
+						 double Dead )
+	{
+		return mLoads.Add( eLoadType::POINT, { Point }, Live, Dead );
+	}
+	size_t AddLineLoad( const CPoint2D& P1,
+						const CPoint2D& P2,
+						double Live,
+						double Dead )
+	{
+		return mLoads.Add( eLoadType::LINE, { P1, P2 }, Live, Dead );
+	}
+	void SetLoad( size_t Load,
+				  double Live,
+				  double Dead )
+	{
+		mLoads.SetMagnitude( Load, Live, Dead );
 	}
 
 	void SetYieldMoments( double MpPosx,
@@ -60,6 +141,10 @@ public:
 	const std::vector<CEdge*>& GetEdges() { return mEdges; };
 	const std::vector<CEdge>& GetBoundaryEdges() { return mBoundaryEdges; };
 	const std::vector<CPoint2D>& GetBoundaryPoints() { return mPoly.GetPoints(); }
+	const std::vector<CNode>& GetNodes() { return mNodes; };
+
+	// Triangles of the mesh made by Discretize, by node ID
+	const std::vector<std::array<size_t, 3>>& GetTriangles() { return mTriangles; };
 
 protected:
 	struct sSupport
@@ -69,6 +154,7 @@ protected:
 	};
 	double mLiveLoad;
 	double mDeadLoad;
+	CLoadTable mLoads;
 	
 	CPoly2D mPoly;
 	std::vector<CPoly2D> mOpenings;
@@ -77,7 +163,7 @@ protected:
 	std::vector<CNode> mNodes;
 	std::vector<CEdge> mBoundaryEdges;
 	std::vector<CEdge> mMeshEdges;
-	std::vector<CEdge> mAdditionalEdges;
+	std::vector<std::vector<CEdge>> mAdditionalEdges;
 	std::vector<CEdge*> mEdges;
 
 	double mMpPosx;
@@ -86,9 +172,32 @@ protected:
 	double mMpNegy;
 
 	std::map<size_t, std::vector<size_t>> mNodeMap;
+	std::vector<std::array<size_t, 3>> mTriangles;
+
+	eNodeOrdering mOrdering;
+	int mThreads;
+
+	bool mCompact;
+	std::vector<sCandidateEdge> mCandidates;
+	std::deque<CEdge> mCompactEdges;
+	std::vector<size_t> mMaterialized;
+
+	size_t mBudget;
+	std::string mPoolFile;
+	CCandidatePool mPool;
+
+	CBoundaryIndex mBoundaryIndex;
 
 	void fTesselate( double Size );
+	void fTesselateLine( const CPoint2D& p1,
+						 const CPoint2D& p2,
+						 eEdgeType Type,
+						 double Size );
+	CPoint2D fGetHolePoint( const CPoly2D& Opening );
 	void fCreateNodes( double Size );
+	void fReorderNodes();
+	void fOrderHilbert( std::vector<size_t>& Order );
+	void fOrderCuthillMcKee( std::vector<size_t>& Order );
 
 	size_t fAddNode( const CPoint2D& Point );
 	void fAddEdge( size_t N1, size_t N2,
@@ -96,18 +205,23 @@ protected:
 				   std::vector<CEdge>& Edges );
 	bool fEdgeAdded( size_t N1,
 					 size_t N2 );
-	void fMoveToEndOfPartition( std::vector<CEdge*>&Edges,
-								size_t& End );
-	void fRemoveOverlappedEdges( std::vector<CEdge*>& Edges );
-	void fOverlapInternal( std::vector<CEdge*>& Edges,
-						   size_t Start,
-						   size_t End );
-	void fRemoveExteriorEdges( std::vector<CEdge*>& Edges,
-							   const CPoly2D& Poly );
-	void fCalulculateUDLFactors( std::vector<CEdge*>& Edges,
-								 size_t Start,
-								 size_t End );
-	void fCalculateUDL( std::vector<double>& LoadVector,
-					   double UDL );
+	void fGenerateCandidates( size_t Begin,
+							  size_t End,
+							  std::vector<std::vector<CEdge>>& Blocks,
+							  const std::vector<CEdge*>& Fixed );
+	void fCompactCandidates();
+	sCandidateEdge fCompactEdge( CEdge* Edge );
+	void fStreamCandidates();
+	void fAddNearestEdges( size_t Node,
+						   std::vector<CEdge>& Edges );
+	size_t fGetCandidateCount();
+	CEdge* fMaterialize( size_t Index,
+						 const sCandidateEdge& Candidate );
+	void fCalculateLoads( const std::vector<CEdge*>& Edges,
+						  std::vector<double>& Live,
+						  std::vector<double>& Dead );
+	void fGetLoadVector( CEdge* Edge,
+						 std::array<double, 3>& Live,
+						 std::array<double, 3>& Dead );
 	
 };
@@ -7,10 +7,10 @@
 #include "Constants.h"
 
 #include <assert.h>
+#include <algorithm>
 
-std::vector<CNode>* CEdge::mNodes = nullptr;
-
-CEdge::CEdge( size_t aN1,
+CEdge::CEdge( std::vector<CNode>* aNodes,
+			  size_t aN1,
 			  size_t aN2,
 			  eEdgeType aType,
 			  double aLength,
@@ -25,7 +25,8 @@ CEdge::CEdge( size_t aN1,
 	MpPosx( aMpPosx ),
 	MpNegx( aMpNegx ),
 	MpPosy( aMpPosy ),
-	MpNegy( aMpNegy )
+	MpNegy( aMpNegy ),
+	mNodes( aNodes )
 {
 	assert( mNodes );
 
@@ -34,9 +35,12 @@ CEdge::CEdge( size_t aN1,
 	Removeable = false;
 	UDLVectorCalculated = false;
 	Delete = false;
+	Age = 0;
+	Drops = 0;
+	Position = 0;
 
-	++Counter;
-	mID = Counter;
+	// Edges are made on the candidate generation threads
+	mID = ++Counter;
 	YieldRatio = 0;
 
 	CVector2D v = ((*mNodes)[N2 - 1].Point - (*mNodes)[N1 - 1].Point) / Length;
@@ -57,101 +61,352 @@ CEdge::GetPoint( size_t Index )
 	return mNodes->at( N2 - 1 ).Point;
 }
 
-void 
-CEdge::SetNodes( std::vector<CNode>* Nodes )
+// Drops the points of a piece that have a gap outside the piece below them,
+// after adding the points where the verticals through the corners cross its
+// edges.  Returns the points left in Points, or kClipFailed.
+static size_t
+RemoveShadowed( CPoint2D* Points,
+				size_t Count,
+				CPoint2D* Scratch,
+				size_t Capacity )
 {
-	mNodes = Nodes;
-}
+	size_t Size = 0;
 
-void
-CEdge::GetUDLLoadVector( std::array<double, 3>& UDLVector,
-						 const CPoly2D& Outline )
-{
-	if ( !UDLVectorCalculated )
+	auto Near = []( CPoint2D a, const CPoint2D& b ) -> bool
 	{
-		mUDLVector[0] = 0;
-		mUDLVector[1] = 0;
-		mUDLVector[2] = 0;
+		return a.DistanceTo( b ) < EPSILON;
+	};
 
-		CVector2D Ray( 0, 1e6 );
-		std::vector<CPoint2D> Intersections;
-		CPoint2D p, c;
+	for ( size_t i = 0; i < Count; ++i )
+	{
+		const CPoint2D& a = Points[i];
+		const CPoint2D& b = Points[(i + 1) % Count];
 
-		CPoint2D p1 = (*mNodes)[N1 - 1].Point;
-		CPoint2D p2 = (*mNodes)[N2 - 1].Point;
+		if ( Size == Capacity )
+			return CPoly2D::kClipFailed;
 
-		if ( abs( p1.x - p2.x ) > EPSILON )
+		Scratch[Size++] = a;
+		size_t First = Size;
+
+		double dx = b.x - a.x;
+		if ( dx == 0 )
+			continue;
+
+		for ( size_t j = 0; j < Count; ++j )
 		{
-			bool left = false;
-			if ( p1.x > p2.x )
+			double t = (Points[j].x - a.x) / dx;
+			if ( t < 0 || t > 1 )
+				continue;
+
+			CPoint2D p = a + (b - a) * t;
+			if ( Near( p, a ) || Near( p, b ) ||
+				 std::any_of( Scratch + First, Scratch + Size, [&]( const CPoint2D& q ) { return Near( p, q ); } ) )
 			{
-				left = true;
-				std::swap( p1, p2 );
+				continue;
 			}
 
-			CLine2D Line1( p1 - Ray, p1 + Ray );
-			CLine2D Line2( p2 - Ray, p2 + Ray );
-			CLine2D Line3( p1, p2 );
+			if ( Size == Capacity )
+				return CPoly2D::kClipFailed;
 
-			std::vector<CPoly2D> Polies = Outline.ClipRight( Line2 );
-			Polies = CPoly2D::GetByPoint( (p1 + p2) / 2, Polies ).ClipLeft( Line1 );
-			Polies = CPoly2D::GetByPoint( (p1 + p2) / 2, Polies ).ClipRight( Line3 );
+			// In order along the edge
+			size_t k = Size++;
+			for ( ; k > First && (Scratch[k - 1].x - a.x) / dx > t; --k )
+				Scratch[k] = Scratch[k - 1];
 
-			CPoly2D Poly = CPoly2D::GetByPoint( (p1 + p2) / 2, Polies );
+			Scratch[k] = p;
+		}
+	}
 
-			std::vector<CPoint2D> Original = Poly.GetPoints();
+	CPoint2D Hits[CPoly2D::kClipCapacity];
+	size_t Kept = 0;
 
-			for ( size_t j = 0; j < Original.size(); ++j )
-			{
-				Line3.Set( Original[j] - Ray, Original[j] + Ray, false );
+	for ( size_t j = 0; j < Size; ++j )
+	{
+		const CPoint2D& p = Scratch[j];
+		size_t NumHits = 0;
+
+		auto AddHit = [&]( const CPoint2D& h ) -> bool
+		{
+			if ( std::any_of( Hits, Hits + NumHits, [&]( const CPoint2D& q ) { return Near( h, q ); } ) )
+				return true;
+
+			if ( NumHits == CPoly2D::kClipCapacity )
+				return false;
+
+			Hits[NumHits++] = h;
+			return true;
+		};
 
-				Intersections = Poly.IntersectWith( Line3 );
+		for ( size_t i = 0; i < Size; ++i )
+		{
+			const CPoint2D& a = Scratch[i];
+			const CPoint2D& b = Scratch[(i + 1) % Size];
+
+			double dx = b.x - a.x;
+			bool Added = true;
+
+			if ( dx == 0 )
+			{
+				if ( abs( p.x - a.x ) < EPSILON )
+					Added = AddHit( a ) && AddHit( b );
 			}
+			else
+			{
+				double t = (p.x - a.x) / dx;
+				if ( t >= -EPSILON && t <= 1 + EPSILON )
+					Added = AddHit( a + (b - a) * t );
+			}
+
+			if ( !Added )
+				return CPoly2D::kClipFailed;
+		}
+
+		std::sort( Hits, Hits + NumHits,
+				   []( const CPoint2D& l, const CPoint2D& r )
+		{
+			return l.y < r.y;
+		}
+		);
 
-			Original = Poly.GetPoints();
-			size_t j = 0;
-			while ( j < Original.size() )
+		bool Remove = false;
+		for ( size_t k = 0; k + 1 < NumHits && Hits[k].y < p.y; ++k )
+		{
+			CPoint2D Mid = (Hits[k] + Hits[k + 1]) / 2;
+			if ( !(CPoly2D::PointOnPoly( Scratch, Size, Mid ) > -1) && !CPoly2D::PointInPoly( Scratch, Size, Mid ) )
 			{
-				Line3.Set( Original[j] - Ray, Original[j] + Ray, false );
+				Remove = true;
+				break;
+			}
+		}
+
+		if ( !Remove )
+			Points[Kept++] = p;
+	}
+
+	return Kept;
+}
+
+size_t
+CEdge::fTributaryPiece( const CPoint2D& p1,
+						const CPoint2D& p2,
+						const CPoly2D& Outline,
+						CPoint2D* Piece,
+						CPoint2D* Scratch )
+{
+	// The strip above the edge clipped out of the outline in the caller's
+	// buffers, the general path only for concave outlines
+	CVector2D Ray( 0, 1e6 );
+	CPoint2D Mid = (p1 + p2) / 2;
+
+	const size_t Capacity = CPoly2D::kClipCapacity;
+
+	const CLine2D Lines[3] = { CLine2D( p2 - Ray, p2 + Ray ),
+							   CLine2D( p1 + Ray, p1 - Ray ),
+							   CLine2D( p1, p2 ) };
+
+	bool Convex = Outline.IsConvex();
+
+	const CPoint2D* Points = &Outline.GetPoint( 0 );
+	size_t Count = Outline.GetNumPoints();
+
+	for ( int i = 0; i < 3 && Count; ++i )
+	{
+		CPoint2D* Result = i % 2 ? Scratch : Piece;
+
+		if ( Convex )
+			Count = CPoly2D::ClipConvex( Points, Count, Lines[i], Result, Capacity );
+		else
+			Count = CPoly2D::ClipPiece( Points, Count, Lines[i], Mid, Result, Capacity );
+
+		if ( Count == CPoly2D::kClipFailed )
+			return Count;
+
+		Points = Result;
+	}
+
+	if ( Count && CPoly2D::Area( Piece, Count ) < 0 )
+		std::reverse( Piece, Piece + Count );
+
+	// A convex piece casts no shadow on itself
+	if ( Count && !Convex )
+		Count = RemoveShadowed( Piece, Count, Scratch, Capacity );
+
+	return Count;
+}
+
+bool
+CEdge::fTributaryArea( const CPoint2D& p1,
+					   const CPoint2D& p2,
+					   const CPoly2D& Outline,
+					   double& A,
+					   CPoint2D& c )
+{
+	CPoint2D Buffer[2][CPoly2D::kClipCapacity];
+
+	CPoint2D* Piece = Buffer[0];
+	size_t Count = fTributaryPiece( p1, p2, Outline, Piece, Buffer[1] );
+
+	if ( Count == CPoly2D::kClipFailed )
+		return false;
+
+	A = 0;
+
+	if ( Count > 2 )
+	{
+		A = CPoly2D::Area( Piece, Count );
+		c = CPoly2D::Centroid( Piece, Count );
+	}
+
+	return true;
+}
+
+void
+CEdge::fTributaryPolygon( const CPoint2D& p1,
+						  const CPoint2D& p2,
+						  const CPoly2D& Outline,
+						  std::vector<CPoint2D>& Piece )
+{
+	CVector2D Ray( 0, 1e6 );
+	std::vector<CPoint2D> Intersections;
+	CPoint2D p;
+
+	CLine2D Line1( p1 - Ray, p1 + Ray );
+	CLine2D Line2( p2 - Ray, p2 + Ray );
+	CLine2D Line3( p1, p2 );
+
+	std::vector<CPoly2D> Polies = Outline.ClipRight( Line2 );
+	Polies = CPoly2D::GetByPoint( (p1 + p2) / 2, Polies ).ClipLeft( Line1 );
+	Polies = CPoly2D::GetByPoint( (p1 + p2) / 2, Polies ).ClipRight( Line3 );
+
+	CPoly2D Poly = CPoly2D::GetByPoint( (p1 + p2) / 2, Polies );
+
+	std::vector<CPoint2D> Original = Poly.GetPoints();
+
+	for ( size_t j = 0; j < Original.size(); ++j )
+	{
+		Line3.Set( Original[j] - Ray, Original[j] + Ray, false );
+
+		Intersections = Poly.IntersectWith( Line3 );
+	}
+
+	Original = Poly.GetPoints();
+	size_t j = 0;
+	while ( j < Original.size() )
+	{
+		Line3.Set( Original[j] - Ray, Original[j] + Ray, false );
 
-				Intersections = Poly.IntersectWith( Line3 );
+		Intersections = Poly.IntersectWith( Line3 );
 
-				bool Remove = false;
-				for ( size_t k = 0; k < Intersections.size() - 1; ++k )
+		bool Remove = false;
+		for ( size_t k = 0; k < Intersections.size() - 1; ++k )
+		{
+			if ( Intersections[k].y - Original[j].y < 0 )
+			{
+				p = (Intersections[k] + Intersections[k + 1]) / 2;
+				if ( !(Poly.PointOnPoly( p ) > -1) && !Poly.PointInPoly( p ) )
 				{
-					if ( Intersections[k].y - Original[j].y < 0 )
-					{
-						p = (Intersections[k] + Intersections[k + 1]) / 2;
-						if ( !(Poly.PointOnPoly( p ) > -1) && !Poly.PointInPoly( p ) )
-						{
-							Remove = true;
-							break;
-						}
-					}
+					Remove = true;
+					break;
 				}
-				if ( Remove )
-					Original.erase( Original.begin() + j );
-				else
-					++j;
 			}
+		}
+		if ( Remove )
+			Original.erase( Original.begin() + j );
+		else
+			++j;
+	}
 
-			if ( Original.size() )
-			{
-				Poly.SetPoints( Original );
-				CPoly2D TestPoly;
+	Piece = Original;
+}
+
+void
+CEdge::fTributaryAreaByPolygons( const CPoint2D& p1,
+								 const CPoint2D& p2,
+								 const CPoly2D& Outline,
+								 double& A,
+								 CPoint2D& c )
+{
+	std::vector<CPoint2D> Piece;
+	fTributaryPolygon( p1, p2, Outline, Piece );
+
+	A = 0;
+
+	if ( Piece.size() )
+	{
+		CPoly2D Poly;
+		Poly.SetPoints( Piece );
+
+		A = Poly.Area();
+		c = Poly.Centroid();
+	}
+}
+
+size_t
+CEdge::GetTributaryArea( const CPoly2D& Outline,
+						 CPoint2D* Piece,
+						 CPoint2D* Scratch,
+						 std::vector<CPoint2D>& Polygon )
+{
+	CPoint2D p1 = (*mNodes)[N1 - 1].Point;
+	CPoint2D p2 = (*mNodes)[N2 - 1].Point;
+
+	// Nothing lies above a vertical edge
+	if ( abs( p1.x - p2.x ) <= EPSILON )
+		return 0;
+
+	if ( p1.x > p2.x )
+		std::swap( p1, p2 );
+
+	size_t Count = fTributaryPiece( p1, p2, Outline, Piece, Scratch );
+
+	if ( Count != CPoly2D::kClipFailed )
+		return Count;
+
+	fTributaryPolygon( p1, p2, Outline, Polygon );
+
+	if ( Polygon.size() && CPoly2D::Area( Polygon.data(), Polygon.size() ) < 0 )
+		std::reverse( Polygon.begin(), Polygon.end() );
+
+	return CPoly2D::kClipFailed;
+}
+
+void
+CEdge::GetUDLLoadVector( std::array<double, 3>& UDLVector,
+						 const CPoly2D& Outline )
+{
+	if ( !UDLVectorCalculated )
+	{
+		mUDLVector[0] = 0;
+		mUDLVector[1] = 0;
+		mUDLVector[2] = 0;
+
+		CPoint2D p1 = (*mNodes)[N1 - 1].Point;
+		CPoint2D p2 = (*mNodes)[N2 - 1].Point;
+
+		if ( abs( p1.x - p2.x ) > EPSILON )
+		{
+			if ( p1.x > p2.x )
+				std::swap( p1, p2 );
+
+			double A;
+			CPoint2D c;
 
-				double A = Poly.Area();
-				c = Poly.Centroid();
+			// Outlines beyond the clipping buffers take the allocating path
+			if ( !fTributaryArea( p1, p2, Outline, A, c ) )
+				fTributaryAreaByPolygons( p1, p2, Outline, A, c );
 
-				p1 = (*mNodes)[N1 - 1].Point;
-				p2 = (*mNodes)[N2 - 1].Point;
+			if ( A != 0 )
+			{
+				CLine2D Line( (*mNodes)[N1 - 1].Point, (*mNodes)[N2 - 1].Point );
 
-				Line3.Set( p1, p2, false );
+				// Tangential lever along the edge from left to right
+				CVector2D v = p2 - p1;
+				v.Normalize();
 
-				p = (p1 + p2) / 2;
+				CPoint2D p = (p1 + p2) / 2;
 
-				double dn = Line3.DistanceTo( c );
-				double dt = Line3.Vector().Dot( c - p );
+				double dn = Line.DistanceTo( c );
+				double dt = v.Dot( c - p );
 
 				mUDLVector[0] = A*dn;
 				mUDLVector[1] = A*dt;
@@ -172,7 +427,7 @@ CEdge::GetUDLLoadVector( std::array<double, 3>& UDLVector,
 	UDLVector = mUDLVector;
 }
 
-int CEdge::Counter = 0;
+std::atomic<int> CEdge::Counter( 0 );
 
 int
 CEdge::DOF()
@@ -186,14 +441,38 @@ CEdge::DOF()
 	return 1;
 }
 
+eEdgeClass
+CEdge::Class()
+{
+	switch ( Type )
+	{
+	case eEdgeType::FREE:
+		return eEdgeClass::FREE;
+	case eEdgeType::SYMMETRY:
+		return eEdgeClass::SYMMETRY;
+	case eEdgeType::SIMPLE_ANCHORED:
+		return eEdgeClass::ANCHORED;
+	default:
+		return eEdgeClass::YIELDING;
+	}
+}
+
 void
-CEdge::GetCompatibilityMatrix( std::vector<std::vector<double>>& Matrix,
-							   bool ApplBoundaryConditions )
+CEdge::GetDirection( double& c,
+					 double& s )
 {
 	CVector2D v = ((*mNodes)[N2 - 1].Point - (*mNodes)[N1 - 1].Point) / Length;
 
-	double c = v.Dot( kXAxis );
-	double s = v.Dot( kYAxis );
+	c = v.Dot( kXAxis );
+	s = v.Dot( kYAxis );
+}
+
+void
+CEdge::GetCompatibilityMatrix( std::vector<std::vector<double>>& Matrix,
+							   bool ApplBoundaryConditions )
+{
+	double c, s;
+	GetDirection( c, s );
 
 	//Node1
 	Matrix[0][0] = c;
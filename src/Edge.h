@@ -11,12 +11,28 @@
 
 #include <vector>
 #include <array>
+#include <atomic>
+#include <cstdint>
+
+// Single precision candidate edge, the pricing kernel only needs the
+// direction, length, normal UDL factor and yield moments.  Accumulation
+// stays in double, the exact CEdge is made once the edge may enter the LP.
+struct sCandidateEdge
+{
+	uint32_t N1, N2;
+	float c, s;
+	float Length;
+	float UDL;
+	float MpPos, MpNeg;
+};
 
 class CEdge
 {
 public:
 
-	CEdge( size_t aN1,
+	// Nodes is the node list of the domain, kept by the edge
+	CEdge( std::vector<CNode>* aNodes,
+		   size_t aN1,
 		   size_t aN2,
 		   eEdgeType aType,
 		   double aLength,
@@ -27,9 +43,20 @@ public:
 
 	void GetCompatibilityMatrix( std::vector<std::vector<double>>& Matrix,
 								 bool ApplBoundaryConditions );
+	void GetDirection( double& c,
+					   double& s );
 	void GetUDLLoadVector( std::array<double, 3>& UDLVector,
 						   const CPoly2D& Outline );
 
+	// The part of Outline above the edge that loads it, anticlockwise in
+	// Piece.  Piece and Scratch hold CPoly2D::kClipCapacity points.  Returns
+	// the number of points, or kClipFailed with the piece in Polygon if the
+	// buffers are too small.
+	size_t GetTributaryArea( const CPoly2D& Outline,
+							 CPoint2D* Piece,
+							 CPoint2D* Scratch,
+							 std::vector<CPoint2D>& Polygon );
+
 	size_t N1, N2;
 	eEdgeType Type;
 	double Length;
@@ -40,19 +67,42 @@ public:
 	bool Added;
 	bool Removeable;
 	bool Delete;
+	int Age;
+	int Drops;
+	size_t Position;
 
 	int DOF();
+	eEdgeClass Class();
 	size_t ID() { return mID; };
 
-	static void SetNodes( std::vector<CNode>* Nodes );
 	const CNode& GetNode( size_t Index ) { return mNodes->at( Index ); }
 	const CPoint2D& GetPoint( size_t Index );
 
 private:
+	size_t fTributaryPiece( const CPoint2D& p1,
+							const CPoint2D& p2,
+							const CPoly2D& Outline,
+							CPoint2D* Piece,
+							CPoint2D* Scratch );
+	bool fTributaryArea( const CPoint2D& p1,
+						 const CPoint2D& p2,
+						 const CPoly2D& Outline,
+						 double& A,
+						 CPoint2D& c );
+	void fTributaryPolygon( const CPoint2D& p1,
+							const CPoint2D& p2,
+							const CPoly2D& Outline,
+							std::vector<CPoint2D>& Piece );
+	void fTributaryAreaByPolygons( const CPoint2D& p1,
+								   const CPoint2D& p2,
+								   const CPoly2D& Outline,
+								   double& A,
+								   CPoint2D& c );
+
 	std::array<double, 3> mUDLVector;
 	bool UDLVectorCalculated;
 	size_t mID;
-	static int Counter;
+	static std::atomic<int> Counter;
 
-	static std::vector<CNode>* mNodes;
+	std::vector<CNode>* mNodes;
 };
\ No newline at end of file
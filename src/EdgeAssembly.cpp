@@ -0,0 +1,128 @@
+// EdgeAssembly.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "EdgeAssembly.h"
+
+#include "Edge.h"
+
+#include <algorithm>
+
+// Structural nonzeros of column j, at x, y and z of the lower and then the
+// higher numbered node
+static constexpr bool kPattern[3][CEdgeAssembly::kMaxEntries] =
+{
+	{ true, true, false, true, true, false },
+	{ true, true, true, true, true, true },
+	{ false, false, true, false, false, true }
+};
+
+template<eEdgeClass Class>
+struct sEdgeClassTraits
+{
+	static constexpr size_t DOF = (Class == eEdgeClass::FREE || Class == eEdgeClass::SYMMETRY) ? 3 : 1;
+};
+
+void
+CEdgeAssembly::Clear()
+{
+	mEdges.clear();
+	mFirst.clear();
+	mCount.clear();
+	mRows.clear();
+	mValues.clear();
+
+	for ( auto& Group : mGroups )
+		Group.clear();
+}
+
+void
+CEdgeAssembly::Reserve( size_t Edges )
+{
+	mEdges.reserve( Edges );
+	mFirst.reserve( Edges );
+	mCount.reserve( 3 * Edges );
+	mRows.reserve( 3 * Edges * kMaxEntries );
+	mValues.reserve( 3 * Edges * kMaxEntries );
+
+	for ( auto& Group : mGroups )
+		Group.reserve( Edges );
+}
+
+size_t
+CEdgeAssembly::Add( CEdge* Edge )
+{
+	size_t First = mCount.size();
+	size_t Columns = First + Edge->DOF();
+
+	mGroups[static_cast<size_t>(Edge->Class())].push_back( static_cast<uint32_t>(mEdges.size()) );
+	mEdges.push_back( Edge );
+	mFirst.push_back( First );
+
+	mCount.resize( Columns );
+	mRows.resize( Columns * kMaxEntries );
+	mValues.resize( Columns * kMaxEntries );
+
+	return First;
+}
+
+void
+CEdgeAssembly::Assemble()
+{
+	fAssemble<eEdgeClass::YIELDING>( mGroups[static_cast<size_t>(eEdgeClass::YIELDING)] );
+	fAssemble<eEdgeClass::FREE>( mGroups[static_cast<size_t>(eEdgeClass::FREE)] );
+	fAssemble<eEdgeClass::SYMMETRY>( mGroups[static_cast<size_t>(eEdgeClass::SYMMETRY)] );
+	fAssemble<eEdgeClass::ANCHORED>( mGroups[static_cast<size_t>(eEdgeClass::ANCHORED)] );
+}
+
+template<eEdgeClass Class>
+void
+CEdgeAssembly::fAssemble( const std::vector<uint32_t>& Group )
+{
+	constexpr size_t DOF = sEdgeClassTraits<Class>::DOF;
+
+	for ( uint32_t Index : Group )
+	{
+		CEdge* Edge = mEdges[Index];
+
+		double c, s;
+		Edge->GetDirection( c, s );
+
+		// The rows of N1 lead when it is the lower numbered node
+		double Sign = Edge->N1 < Edge->N2 ? 1.0 : -1.0;
+		double Half = Edge->Length / 2;
+
+		int Lo = 3 * static_cast<int>(std::min( Edge->N1, Edge->N2 )) - 3;
+		int Hi = 3 * static_cast<int>(std::max( Edge->N1, Edge->N2 )) - 3;
+
+		const int Rows[kMaxEntries] = { Lo, Lo + 1, Lo + 2, Hi, Hi + 1, Hi + 2 };
+		const double Values[3][kMaxEntries] =
+		{
+			{ Sign * c, Sign * s, 0, -Sign * c, -Sign * s, 0 },
+			{ -Sign * s, Sign * c, Half, Sign * s, -Sign * c, Half },
+			{ 0, 0, Sign, 0, 0, -Sign }
+		};
+
+		for ( size_t j = 0; j < DOF; ++j )
+		{
+			size_t Column = mFirst[Index] + j;
+
+			int* r = &mRows[Column * kMaxEntries];
+			double* v = &mValues[Column * kMaxEntries];
+			size_t n = 0;
+
+			// Every structural entry is written, only nonzeros advance
+			for ( size_t k = 0; k < kMaxEntries; ++k )
+			{
+				if ( !kPattern[j][k] )
+					continue;
+
+				r[n] = Rows[k];
+				v[n] = Values[j][k];
+				n += Values[j][k] != 0;
+			}
+
+			mCount[Column] = static_cast<uint8_t>(n);
+		}
+	}
+}
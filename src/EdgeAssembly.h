@@ -0,0 +1,51 @@
+// EdgeAssembly.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include "Enums.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CEdge;
+
+// Compatibility matrix columns of the edges entering the LP.  The edges are
+// grouped by class and each group is filled by a kernel specialised on the
+// class, the DOFs and structural nonzeros of its columns are fixed at
+// compile time.  Column j of an edge holds the entries at its lower
+// numbered node first, exact zeros are dropped as the LP never stored them.
+class CEdgeAssembly
+{
+public:
+	// Most entries of one column: x, y and z of both nodes
+	static const size_t kMaxEntries = 6;
+
+	void Clear();
+	void Reserve( size_t Edges );
+
+	// Returns the first column of the edge, columns follow the order of Add
+	size_t Add( CEdge* Edge );
+	void Assemble();
+
+	size_t GetColumns() const { return mCount.size(); };
+	size_t GetCount( size_t Column ) const { return mCount[Column]; };
+	const int* GetRows( size_t Column ) const { return &mRows[Column * kMaxEntries]; };
+	const double* GetValues( size_t Column ) const { return &mValues[Column * kMaxEntries]; };
+
+	static bool IsYielding( eEdgeClass Class ) { return Class == eEdgeClass::YIELDING || Class == eEdgeClass::SYMMETRY; };
+
+protected:
+	std::vector<CEdge*> mEdges;
+	std::vector<size_t> mFirst;
+	std::vector<uint32_t> mGroups[4];
+
+	std::vector<uint8_t> mCount;
+	std::vector<int> mRows;
+	std::vector<double> mValues;
+
+	template<eEdgeClass Class>
+	void fAssemble( const std::vector<uint32_t>& Group );
+};
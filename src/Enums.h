@@ -14,4 +14,63 @@ enum class eEdgeType
 	KNIFE_EDGE_ANCHORED,
 	KNIFE_EDGE_UNANCHORED,
 	INTERNAL
+};
+
+// Assembly class of an edge type: its DOFs and whether it has a yield row
+enum class eEdgeClass
+{
+	YIELDING = 0,	// 1 DOF with a yield row
+	FREE,			// 3 DOF
+	SYMMETRY,		// 3 DOF with a yield row
+	ANCHORED		// 1 DOF
+};
+
+enum class eIntersectionType
+{
+	NONE = 0,
+	POINT,
+	OVERLAP
+};
+
+enum class eLoadType
+{
+	AREA = 0,
+	POINT,
+	LINE
+};
+
+enum class eCholeskyType
+{
+	NATIVE = 0,
+	DENSE,
+	UFL,
+	PARDISO
+};
+
+enum class eLPAlgorithm
+{
+	BARRIER = 0,
+	DUAL_SIMPLEX,
+	PRIMAL_SIMPLEX,
+	CONCURRENT,
+	FIRST_ORDER
+};
+
+enum class eLPBackend
+{
+	CLP = 0,
+	HIGHS
+};
+
+enum class eDLOFormulation
+{
+	KINEMATIC = 0,
+	EQUILIBRIUM
+};
+
+enum class eNodeOrdering
+{
+	NONE = 0,
+	HILBERT,
+	REVERSE_CUTHILL_MCKEE
 };
\ No newline at end of file
@@ -0,0 +1,367 @@
+// HighsDLOSolver.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "HighsDLOSolver.h"
+
+#include "Constants.h"
+#include "Domain.h"
+
+#include <algorithm>
+
+double
+CHighsDLOSolver::Solve( CDomain* Domain )
+{
+	mDomain = Domain;
+	fBuildModel();
+
+	return CDLOSolver::Solve( Domain );
+}
+
+void
+CHighsDLOSolver::fGetColumnSolution()
+{
+	fResizeResult( mNumDisp + mNumYEdges * 2 );
+
+	// The model holds the edges in the order they were admitted, the result
+	// array is expected in mEdges order: all displacements first, then the
+	// plastic multiplier pairs.
+	const std::vector<double>& Values = mHighs.getSolution().col_value;
+
+	size_t Disp = 0;
+	size_t Mult = mNumDisp;
+
+	for ( auto Edge : mActiveEdges )
+	{
+		if ( Edge->Added )
+		{
+			const sModelEdge& ModelEdge = mModelEdges[mModelIndex[Edge->Position]];
+			HighsInt DOF = Edge->DOF();
+
+			for ( HighsInt j = 0; j < DOF; ++j )
+				mResultArray[Disp++] = Values[ModelEdge.Column + j];
+
+			if ( ModelEdge.Row != -1 )
+			{
+				mResultArray[Mult++] = Values[ModelEdge.Column + DOF];
+				mResultArray[Mult++] = Values[ModelEdge.Column + DOF + 1];
+			}
+		}
+	}
+}
+
+double*
+CHighsDLOSolver::fSolve( double& Objective )
+{
+	double* Result = nullptr;
+
+	mNumDisp = fGetEdgeVarCount();
+	mNumYEdges = fGetYieldingEdges();
+	mNumDOF = fGetEdgeDOFCount();
+
+	fRemoveEdges();
+	fAppendEdges();
+	fSetAlgorithmOptions();
+
+	mHighs.run();
+
+	if ( mHighs.getModelStatus() != HighsModelStatus::kOptimal )
+		return nullptr;
+
+	Objective = mHighs.getInfo().objective_function_value;
+
+	size_t NodeRows = mDomain->mNodes.size() * 3;
+	size_t numcon = NodeRows + mNumYEdges + 1;
+
+	const std::vector<double>& RowDuals = mHighs.getSolution().row_dual;
+
+	Result = mArena.Allocate<double>( numcon );
+	if ( Result )
+	{
+		std::copy( RowDuals.begin(), RowDuals.begin() + NodeRows, Result );
+
+		size_t Row = NodeRows;
+		for ( auto Edge : mActiveEdges )
+		{
+			if ( Edge->Added &&
+				 Edge->Type != eEdgeType::FREE &&
+				 Edge->Type != eEdgeType::SIMPLE_ANCHORED )
+			{
+				Result[Row] = RowDuals[mModelEdges[mModelIndex[Edge->Position]].Row];
+				++Row;
+			}
+		}
+
+		Result[numcon - 1] = RowDuals[NodeRows];
+	}
+
+	fGetColumnSolution();
+
+	return Result;
+}
+
+bool
+CHighsDLOSolver::fInModel( const CEdge* Edge )
+{
+	return Edge->Position < mModelIndex.size() && mModelIndex[Edge->Position] != kNotInModel;
+}
+
+void
+CHighsDLOSolver::fSetModelIndex( const CEdge* Edge,
+								 size_t Index )
+{
+	// Edges materialized during the solve are numbered after the others
+	if ( Edge->Position >= mModelIndex.size() )
+		mModelIndex.resize( Edge->Position + 1, kNotInModel );
+
+	mModelIndex[Edge->Position] = Index;
+}
+
+void
+CHighsDLOSolver::fBuildModel()
+{
+	mHighs.clearModel();
+	mModelEdges.clear();
+	mModelIndex.assign( mDomain->mEdges.size(), kNotInModel );
+
+	mHighs.setOptionValue( "output_flag", false );
+
+	// HiGHS sizes its task scheduler on the first run in the process, later
+	// changes to the thread count only apply to new processes.
+	if ( mThreads > 0 )
+		mHighs.setOptionValue( "threads", mThreads );
+
+	// Equilibrium rows for every node followed by the unit work row, yield
+	// rows are appended with their edges.
+	HighsInt NodeRows = static_cast<HighsInt>(mDomain->mNodes.size() * 3);
+
+	std::vector<double> Lower( NodeRows + 1, 0.0 );
+	std::vector<double> Upper( NodeRows + 1, 0.0 );
+
+	Lower.back() = Upper.back() = 1.0;
+
+	mHighs.addRows( NodeRows + 1, &Lower[0], &Upper[0], 0, nullptr, nullptr, nullptr );
+}
+
+void
+CHighsDLOSolver::fSetAlgorithmOptions()
+{
+	mHighs.setOptionValue( "primal_feasibility_tolerance", mTolerance );
+	mHighs.setOptionValue( "dual_feasibility_tolerance", mTolerance );
+	mHighs.setOptionValue( "ipm_optimality_tolerance", mTolerance );
+
+	switch ( mAlgorithm )
+	{
+	case eLPAlgorithm::BARRIER:
+		// Loose iterates are only used for pricing, crossover is left to
+		// the tight solves
+		mHighs.setOptionValue( "solver", "ipm" );
+		mHighs.setOptionValue( "run_crossover", fIsTight() ? "on" : "off" );
+		mIterationAlgorithm = eLPAlgorithm::BARRIER;
+		break;
+	case eLPAlgorithm::FIRST_ORDER:
+		mHighs.setOptionValue( "solver", "pdlp" );
+		mIterationAlgorithm = eLPAlgorithm::FIRST_ORDER;
+		break;
+	case eLPAlgorithm::PRIMAL_SIMPLEX:
+		mHighs.setOptionValue( "solver", "simplex" );
+		mHighs.setOptionValue( "simplex_strategy", kSimplexStrategyPrimal );
+		mIterationAlgorithm = eLPAlgorithm::PRIMAL_SIMPLEX;
+		break;
+	default:
+		mHighs.setOptionValue( "solver", "simplex" );
+
+		if ( mThreads == 1 )
+			mHighs.setOptionValue( "simplex_strategy", kSimplexStrategyDual );
+		else
+			mHighs.setOptionValue( "simplex_strategy", kSimplexStrategyDualMulti );
+
+		mIterationAlgorithm = eLPAlgorithm::DUAL_SIMPLEX;
+		break;
+	}
+}
+
+void
+CHighsDLOSolver::fAppendEdges()
+{
+	std::vector<CEdge*>& Edges = mActiveEdges;
+
+	std::array<double, 3> LiveVector, DeadVector;
+
+	std::vector<double>& Cost = mCost;
+	std::vector<double>& Lower = mLower;
+	std::vector<double>& Upper = mUpper;
+	std::vector<double>& Value = mValue;
+	std::vector<HighsInt>& Start = mStart;
+	std::vector<HighsInt>& Index = mIndex;
+
+	Cost.clear();
+	Lower.clear();
+	Upper.clear();
+	Value.clear();
+	Start.clear();
+	Index.clear();
+
+	HighsInt NumRows = mHighs.getNumRow();
+	HighsInt NumCols = mHighs.getNumCol();
+	HighsInt NewRows = 0;
+	HighsInt LoadRow = static_cast<HighsInt>(mDomain->mNodes.size() * 3);
+
+	mAssembly.Clear();
+
+	for ( auto Edge : Edges )
+	{
+		if ( Edge->Added && !fInModel( Edge ) )
+			mAssembly.Add( Edge );
+	}
+
+	mAssembly.Assemble();
+
+	size_t Column = 0;
+
+	for ( auto Edge : Edges )
+	{
+		if ( !Edge->Added || fInModel( Edge ) )
+			continue;
+
+		sModelEdge ModelEdge = { Edge, NumCols + static_cast<HighsInt>(Start.size()), -1 };
+
+		if ( Edge->Type != eEdgeType::FREE &&
+			 Edge->Type != eEdgeType::SIMPLE_ANCHORED )
+		{
+			ModelEdge.Row = NumRows + NewRows;
+			++NewRows;
+		}
+
+		mDomain->fGetLoadVector( Edge, LiveVector, DeadVector );
+
+		size_t DOF = static_cast<size_t>(Edge->DOF());
+
+		for ( size_t j = 0; j < DOF; ++j, ++Column )
+		{
+			Start.push_back( static_cast<HighsInt>(Index.size()) );
+
+			fCalculateEdgeColumn( Column, j == 0 ? ModelEdge.Row : -1, Index, Value );
+
+			if ( abs( LiveVector[j] ) > EPSILON )
+			{
+				Index.push_back( LoadRow );
+				Value.push_back( LiveVector[j] );
+			}
+
+			Cost.push_back( DeadVector[j] );
+			Lower.push_back( -kHighsInf );
+			Upper.push_back( kHighsInf );
+		}
+
+		if ( ModelEdge.Row != -1 )
+		{
+			Start.push_back( static_cast<HighsInt>(Index.size()) );
+			Index.push_back( ModelEdge.Row );
+			Value.push_back( 1.0 );
+			Cost.push_back( Edge->MpPos * Edge->Length );
+			Lower.push_back( 0.0 );
+			Upper.push_back( kHighsInf );
+
+			Start.push_back( static_cast<HighsInt>(Index.size()) );
+			Index.push_back( ModelEdge.Row );
+			Value.push_back( -1.0 );
+			Cost.push_back( Edge->MpNeg * Edge->Length );
+			Lower.push_back( 0.0 );
+			Upper.push_back( kHighsInf );
+		}
+
+		fSetModelIndex( Edge, mModelEdges.size() );
+		mModelEdges.push_back( ModelEdge );
+	}
+
+	// New yield rows start out empty and basic, the columns appended below
+	// are nonbasic, so the current basis stays valid.
+	if ( NewRows )
+	{
+		mZero.assign( NewRows, 0.0 );
+		mHighs.addRows( NewRows, &mZero[0], &mZero[0], 0, nullptr, nullptr, nullptr );
+	}
+
+	if ( Start.size() )
+	{
+		mHighs.addCols( static_cast<HighsInt>(Start.size()),
+						&Cost[0], &Lower[0], &Upper[0],
+						static_cast<HighsInt>(Index.size()),
+						&Start[0], &Index[0], &Value[0] );
+	}
+}
+
+void
+CHighsDLOSolver::fRemoveEdges()
+{
+	std::vector<HighsInt>& ColumnMask = mColumnMask;
+	std::vector<HighsInt>& RowMask = mRowMask;
+
+	ColumnMask.assign( mHighs.getNumCol(), 0 );
+	RowMask.assign( mHighs.getNumRow(), 0 );
+
+	bool Remove = false;
+
+	for ( const auto& ModelEdge : mModelEdges )
+	{
+		if ( ModelEdge.Edge->Added )
+			continue;
+
+		HighsInt Columns = ModelEdge.Edge->DOF() + (ModelEdge.Row != -1 ? 2 : 0);
+		for ( HighsInt j = 0; j < Columns; ++j )
+			ColumnMask[ModelEdge.Column + j] = 1;
+
+		if ( ModelEdge.Row != -1 )
+			RowMask[ModelEdge.Row] = 1;
+
+		Remove = true;
+	}
+
+	if ( !Remove )
+		return;
+
+	// On return the masks hold the new index of every kept column and row
+	mHighs.deleteCols( &ColumnMask[0] );
+	mHighs.deleteRows( &RowMask[0] );
+
+	std::vector<sModelEdge>& ModelEdges = mKeptEdges;
+	ModelEdges.clear();
+
+	for ( auto ModelEdge : mModelEdges )
+	{
+		if ( !ModelEdge.Edge->Added )
+		{
+			fSetModelIndex( ModelEdge.Edge, kNotInModel );
+			continue;
+		}
+
+		ModelEdge.Column = ColumnMask[ModelEdge.Column];
+		if ( ModelEdge.Row != -1 )
+			ModelEdge.Row = RowMask[ModelEdge.Row];
+
+		fSetModelIndex( ModelEdge.Edge, ModelEdges.size() );
+		ModelEdges.push_back( ModelEdge );
+	}
+
+	mModelEdges.swap( ModelEdges );
+}
+
+void
+CHighsDLOSolver::fCalculateEdgeColumn( size_t Column,
+									   HighsInt YieldRow,
+									   std::vector<HighsInt>& Index,
+									   std::vector<double>& Value )
+{
+	const int* Rows = mAssembly.GetRows( Column );
+	const double* Values = mAssembly.GetValues( Column );
+
+	Index.insert( Index.end(), Rows, Rows + mAssembly.GetCount( Column ) );
+	Value.insert( Value.end(), Values, Values + mAssembly.GetCount( Column ) );
+
+	if ( YieldRow != -1 )
+	{
+		Index.push_back( YieldRow );
+		Value.push_back( -1.0 );
+	}
+}
@@ -0,0 +1,79 @@
+// HighsDLOSolver.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include "DLOSolver.h"
+#include "Highs.h"
+
+class CEdge;
+
+// Keeps one HiGHS model alive for the whole of Solve.  Edges admitted by
+// pricing are appended as new rows/columns so that the dual simplex restarts
+// from the previous basis instead of from scratch.
+class CHighsDLOSolver : public CDLOSolver
+{
+public:
+	CHighsDLOSolver():
+		mThreads( 0 ),
+		mAlgorithm( eLPAlgorithm::DUAL_SIMPLEX )
+	{
+	};
+
+	virtual ~CHighsDLOSolver() {};
+
+	double Solve( CDomain* Domain ) override;
+
+	void SetThreads( int Threads ) { mThreads = Threads; };
+	int GetThreads() { return mThreads; };
+
+	// BARRIER runs ipm with crossover, FIRST_ORDER runs pdlp, both lose the
+	// basis of the previous iteration.  CONCURRENT is solved with dual simplex.
+	void SetAlgorithm( eLPAlgorithm Algorithm ) { mAlgorithm = Algorithm; };
+	eLPAlgorithm GetAlgorithm() { return mAlgorithm; };
+
+protected:
+	struct sModelEdge
+	{
+		CEdge* Edge;
+		HighsInt Column;
+		HighsInt Row;
+	};
+
+	friend class CAutoDLOSolver;
+
+	Highs mHighs;
+	int mThreads;
+	eLPAlgorithm mAlgorithm;
+
+	std::vector<sModelEdge> mModelEdges;
+	std::vector<sModelEdge> mKeptEdges;
+
+	// Model edge of every domain edge by its Position, kNotInModel for the
+	// edges outside the model
+	static constexpr size_t kNotInModel = ~size_t( 0 );
+	std::vector<size_t> mModelIndex;
+
+	// Columns appended and rows and columns removed by the next LP, these
+	// keep their capacity between iterations
+	std::vector<double> mCost, mLower, mUpper, mValue, mZero;
+	std::vector<HighsInt> mStart, mIndex;
+	std::vector<HighsInt> mColumnMask, mRowMask;
+
+	double* fSolve( double& Objective ) override;
+	void fGetColumnSolution() override;
+
+	bool fInModel( const CEdge* Edge );
+	void fSetModelIndex( const CEdge* Edge,
+						 size_t Index );
+
+	void fBuildModel();
+	void fSetAlgorithmOptions();
+	void fAppendEdges();
+	void fRemoveEdges();
+	void fCalculateEdgeColumn( size_t Column,
+							   HighsInt YieldRow,
+							   std::vector<HighsInt>& Index,
+							   std::vector<double>& Value );
+};
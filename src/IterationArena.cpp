@@ -0,0 +1,68 @@
+// IterationArena.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "IterationArena.h"
+
+#include <cstdint>
+
+CIterationArena::CIterationArena():
+	mCapacity( 0 ),
+	mUsed( 0 ),
+	mOverflowBytes( 0 )
+{
+}
+
+CIterationArena::~CIterationArena()
+{
+}
+
+void
+CIterationArena::Reserve( size_t Bytes )
+{
+	Reset();
+
+	if ( Bytes <= mCapacity )
+		return;
+
+	mBlock.reset( new char[Bytes] );
+	mCapacity = Bytes;
+}
+
+void
+CIterationArena::Reset()
+{
+	// Whatever spilled over is the size the last iteration needed
+	if ( mOverflow.size() )
+	{
+		size_t Bytes = mCapacity + mOverflowBytes;
+
+		mOverflow.clear();
+		mOverflowBytes = 0;
+
+		mBlock.reset( new char[Bytes] );
+		mCapacity = Bytes;
+	}
+
+	mUsed = 0;
+}
+
+void*
+CIterationArena::fAllocate( size_t Bytes,
+							size_t Alignment )
+{
+	uintptr_t Base = reinterpret_cast<uintptr_t>(mBlock.get());
+	size_t Offset = (Base + mUsed + Alignment - 1) / Alignment * Alignment - Base;
+
+	if ( mBlock && Offset + Bytes <= mCapacity )
+	{
+		mUsed = Offset + Bytes;
+		return mBlock.get() + Offset;
+	}
+
+	// new[] memory is aligned for any fundamental type
+	mOverflow.push_back( std::unique_ptr<char[]>( new char[Bytes + Alignment] ) );
+	mOverflowBytes += Bytes + Alignment;
+
+	return mOverflow.back().get();
+}
@@ -0,0 +1,48 @@
+// IterationArena.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Monotonic buffer for the scratch arrays of one column generation
+// iteration.  Allocations only bump an offset and are all released together
+// by Reset.  Requests beyond the reserved block are served from overflow
+// blocks, Reset folds those into one larger block so the next iteration
+// fits again without allocating.
+class CIterationArena
+{
+public:
+	CIterationArena();
+	virtual ~CIterationArena();
+
+	// Grows the block to at least Bytes, releases all allocations
+	void Reserve( size_t Bytes );
+	void Reset();
+
+	template<class T>
+	T* Allocate( size_t Count )
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+
+		return static_cast<T*>(fAllocate( Count * sizeof( T ), alignof(T) ));
+	};
+
+	size_t GetCapacity() { return mCapacity; };
+	size_t GetUsed() { return mUsed + mOverflowBytes; };
+
+protected:
+	std::unique_ptr<char[]> mBlock;
+	size_t mCapacity;
+	size_t mUsed;
+
+	std::vector<std::unique_ptr<char[]>> mOverflow;
+	size_t mOverflowBytes;
+
+	void* fAllocate( size_t Bytes,
+					 size_t Alignment );
+};
@@ -0,0 +1,179 @@
+// LPSelector.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "LPSelector.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+CLPSelector::CLPSelector():
+	mPin( { eLPBackend::CLP, eLPAlgorithm::BARRIER, false } ),
+	mPinned( false )
+{
+	// Uncalibrated defaults: barrier for cold solves, a warm dual simplex for
+	// the increments and a first order method once the LP is very large
+	mCosts =
+	{
+		{ { eLPBackend::CLP, eLPAlgorithm::BARRIER, false }, 2e-3, 3e-7, 1.25 },
+		{ { eLPBackend::CLP, eLPAlgorithm::DUAL_SIMPLEX, false }, 1e-3, 1e-7, 1.5 },
+		{ { eLPBackend::HIGHS, eLPAlgorithm::BARRIER, false }, 2e-3, 4e-7, 1.25 },
+		{ { eLPBackend::HIGHS, eLPAlgorithm::DUAL_SIMPLEX, false }, 1e-3, 1e-7, 1.5 },
+		{ { eLPBackend::HIGHS, eLPAlgorithm::DUAL_SIMPLEX, true }, 5e-4, 1e-6, 1.2 },
+		{ { eLPBackend::HIGHS, eLPAlgorithm::FIRST_ORDER, false }, 0.5, 2e-5, 1.0 }
+	};
+
+	mAvailable[eLPBackend::CLP] = true;
+	mAvailable[eLPBackend::HIGHS] = false;
+}
+
+bool
+CLPSelector::fIsUsable( const sLPCost& Cost,
+						const sLPFeatures& Features )
+{
+	if ( !mAvailable[Cost.Choice.Backend] )
+		return false;
+
+	if ( Cost.Choice.Warm )
+		return Features.WarmStart && Features.WarmBackend == Cost.Choice.Backend;
+
+	return true;
+}
+
+double
+CLPSelector::Estimate( const sLPCost& Cost,
+					   const sLPFeatures& Features )
+{
+	double Size = static_cast<double>(Cost.Choice.Warm ? Features.NewNonzeros : Features.Nonzeros);
+
+	return Cost.Fixed + Cost.Scale * pow( std::max( Size, 1.0 ), Cost.Exponent );
+}
+
+sLPChoice
+CLPSelector::Select( const sLPFeatures& Features )
+{
+	if ( mPinned )
+		return mPin;
+
+	sLPChoice Result = { eLPBackend::CLP, eLPAlgorithm::BARRIER, false };
+	double Best = DBL_MAX;
+
+	for ( const auto& Cost : mCosts )
+	{
+		if ( !fIsUsable( Cost, Features ) )
+			continue;
+
+		double Time = Estimate( Cost, Features );
+		if ( Time < Best )
+		{
+			Best = Time;
+			Result = Cost.Choice;
+		}
+	}
+
+	return Result;
+}
+
+void
+CLPSelector::Calibrate( const std::vector<sLPSample>& Samples )
+{
+	for ( auto& Cost : mCosts )
+	{
+		// Least squares fit of log(Time - Fixed) = log(Scale) + Exponent*log(Size)
+		double Sx = 0, Sy = 0, Sxx = 0, Sxy = 0;
+		size_t Count = 0;
+
+		for ( const auto& Sample : Samples )
+		{
+			if ( Sample.Choice.Backend != Cost.Choice.Backend ||
+				 Sample.Choice.Algorithm != Cost.Choice.Algorithm ||
+				 Sample.Choice.Warm != Cost.Choice.Warm ||
+				 Sample.Size < 1.0 ||
+				 Sample.Time <= Cost.Fixed )
+				continue;
+
+			double x = log( Sample.Size );
+			double y = log( Sample.Time - Cost.Fixed );
+
+			Sx += x;
+			Sy += y;
+			Sxx += x * x;
+			Sxy += x * y;
+			++Count;
+		}
+
+		if ( Count == 0 )
+			continue;
+
+		double Denominator = Count * Sxx - Sx * Sx;
+
+		if ( Count > 1 && Denominator > 1e-12 )
+		{
+			Cost.Exponent = (Count * Sxy - Sx * Sy) / Denominator;
+			Cost.Scale = exp( (Sy - Cost.Exponent * Sx) / Count );
+		}
+		else
+		{
+			// All samples of the same size, keep the exponent
+			Cost.Scale = exp( (Sy - Cost.Exponent * Sx) / Count );
+		}
+	}
+}
+
+bool
+CLPSelector::Load( const std::string& File )
+{
+	std::ifstream input;
+	input.open( File, std::ifstream::in );
+
+	if ( !input.is_open() )
+		return false;
+
+	size_t sz = 0;
+	input >> sz;
+
+	std::vector<sLPCost> Costs;
+
+	for ( size_t i = 0; i < sz; ++i )
+	{
+		int Backend, Algorithm, Warm;
+		sLPCost Cost;
+
+		input >> Backend >> Algorithm >> Warm >> Cost.Fixed >> Cost.Scale >> Cost.Exponent;
+
+		if ( !input )
+			return false;
+
+		Cost.Choice = { (eLPBackend)Backend, (eLPAlgorithm)Algorithm, Warm != 0 };
+		Costs.push_back( Cost );
+	}
+
+	mCosts = Costs;
+
+	return true;
+}
+
+void
+CLPSelector::Save( const std::string& File )
+{
+	std::ofstream output;
+	output.open( File, std::ofstream::out );
+
+	// Every digit, a loaded file makes the same choices as the saved model
+	output.precision( std::numeric_limits<double>::max_digits10 );
+
+	output << mCosts.size() << std::endl;
+	for ( const auto& Cost : mCosts )
+		output <<
+		(int)Cost.Choice.Backend << " " <<
+		(int)Cost.Choice.Algorithm << " " <<
+		(int)Cost.Choice.Warm << " " <<
+		Cost.Fixed << " " <<
+		Cost.Scale << " " <<
+		Cost.Exponent << std::endl;
+
+	output.close();
+}
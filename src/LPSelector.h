@@ -0,0 +1,82 @@
+// LPSelector.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include "Enums.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// Size of the LP about to be solved, known before fSolve
+struct sLPFeatures
+{
+	int Iteration;
+	size_t Nodes;
+	size_t ActiveEdges;
+	size_t Nonzeros;
+	size_t NewNonzeros;
+	bool WarmStart;
+	eLPBackend WarmBackend;
+};
+
+struct sLPChoice
+{
+	eLPBackend Backend;
+	eLPAlgorithm Algorithm;
+	bool Warm;
+};
+
+// Estimated time is Fixed + Scale * Size^Exponent, where Size is the number of
+// nonzeros of the LP, or of the increment for warm started entries
+struct sLPCost
+{
+	sLPChoice Choice;
+	double Fixed;
+	double Scale;
+	double Exponent;
+};
+
+struct sLPSample
+{
+	sLPChoice Choice;
+	double Size;
+	double Time;
+};
+
+class CLPSelector
+{
+public:
+	CLPSelector();
+	virtual ~CLPSelector() {};
+
+	sLPChoice Select( const sLPFeatures& Features );
+	double Estimate( const sLPCost& Cost,
+					 const sLPFeatures& Features );
+
+	// Refits Scale and Exponent of every entry that has samples
+	void Calibrate( const std::vector<sLPSample>& Samples );
+
+	bool Load( const std::string& File );
+	void Save( const std::string& File );
+
+	void SetAvailable( eLPBackend Backend, bool Available ) { mAvailable[Backend] = Available; };
+
+	// Always returns Choice, used for benchmark runs
+	void Pin( const sLPChoice& Choice ) { mPin = Choice; mPinned = true; };
+	void Unpin() { mPinned = false; };
+
+	const std::vector<sLPCost>& GetCosts() { return mCosts; };
+
+protected:
+	std::vector<sLPCost> mCosts;
+	std::map<eLPBackend, bool> mAvailable;
+	sLPChoice mPin;
+	bool mPinned;
+
+	bool fIsUsable( const sLPCost& Cost,
+					const sLPFeatures& Features );
+};
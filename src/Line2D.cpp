@@ -10,38 +10,35 @@
 
 #include <vector>
 #include <algorithm>
-#include "Vector2D.h"
+#include "Vector2d.h"
 #include "Constants.h"
 
-//required input point must be colinear with the line
-bool on_segment( const CVector2D& p, const CLine2D& l )
-{
-	//if a point is on the line, the sum of the vectors formed by the point to the line endpoints must be equal
-	CVector2D va = p - l.P1();
-	CVector2D vb = p - l.P2();
-	double ma = va.Length();
-	double mb = vb.Length();
-	double ml = (l.P2() - l.P1()).Length();
-	double s = ma + mb;
-	bool r = s <= ml + EPSILON;
-	return r;
-}
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-void MakeUnique( std::vector<CVector2D>& List )
+#define LEPSILON 11e-12
+
+// p colinear with the segment a + t*d lies on it, within EPSILON / 2 of
+// its ends.  Compared squared, no roots.
+static bool
+OnSegment( const CVector2D& p,
+		   const CVector2D& a,
+		   const CVector2D& d )
 {
-	size_t i = 0;
-	while ( i < List.size() )
-	{
-		size_t j = i + 1;
-		while ( j < List.size() )
-		{
-			if ( (List[i] - List[j]).LengthSquared() < EPSILON )
-				List.erase( List.begin() + j );
-			else
-				++j;
-		}
-		++i;
-	}
+	double s = (p - a).Dot( d );
+	double dd = d.Dot( d );
+	double Slack = EPSILON * EPSILON / 4;
+
+	if ( dd == 0 )
+		return (p - a).Dot( p - a ) <= Slack;
+
+	if ( s < 0 )
+		return s * s <= Slack * dd;
+	if ( s > dd )
+		return (s - dd) * (s - dd) <= Slack * dd;
+
+	return true;
 }
 
 bool Colinear( const CLine2D& la,
@@ -57,17 +54,45 @@ bool Colinear( const CLine2D& la,
 		  abs( va.y + vb.y ) < EPSILON);
 }
 
-//compute using vector math
-//returns 0 points if the lines do not intersect or overlap
-//returns 1 point if the lines intersect
-//returns 2 points if the lines overlap, contain the points where overlapping start starts and stop
-void Intersect( const CLine2D& la, 
-				const CLine2D& lb,
-				std::vector<CVector2D>& Points )
+// The ends of either segment that lie on the other one bound the overlap
+static sIntersection
+Overlap( const CVector2D& oa,
+		 const CVector2D& da,
+		 const CVector2D& ob,
+		 const CVector2D& db )
 {
-	Points.clear();
+	sIntersection Result;
+	int Count = 0;
 
-#define LEPSILON 11e-12
+	auto Add = [&]( const CVector2D& p )
+	{
+		if ( Count == 2 || (Count == 1 && (p - Result.P1).LengthSquared() < EPSILON * EPSILON) )
+			return;
+
+		(Count == 0 ? Result.P1 : Result.P2) = p;
+		++Count;
+	};
+
+	if ( OnSegment( ob, oa, da ) )
+		Add( ob );
+	if ( OnSegment( ob + db, oa, da ) )
+		Add( ob + db );
+	if ( OnSegment( oa, ob, db ) )
+		Add( oa );
+	if ( OnSegment( oa + da, ob, db ) )
+		Add( oa + da );
+
+	Result.Type = Count == 0 ? eIntersectionType::NONE :
+		Count == 1 ? eIntersectionType::POINT : eIntersectionType::OVERLAP;
+
+	return Result;
+}
+
+sIntersection
+Intersect( const CLine2D& la,
+		   const CLine2D& lb )
+{
+	sIntersection Result;
 
 	CVector2D oa, ob, da, db; //origin and direction vectors
 	double sa, sb; //scalar values
@@ -76,61 +101,110 @@ void Intersect( const CLine2D& la,
 	ob = lb.P1();
 	db = lb.P2() - lb.P1();
 
-	if ( abs( da*db ) < LEPSILON && abs( (ob - oa)*da ) < LEPSILON ) //if colinear
-	{
-		if ( on_segment( lb.P1(), la ) && on_segment( lb.P2(), la ) )
-		{
-			Points.push_back( lb.P1() );
-			Points.push_back( lb.P2() );
-			MakeUnique( Points );
-			return;
-		}
-
-		if ( on_segment( la.P1(), lb ) && on_segment( la.P2(), lb ) )
-		{
-			Points.push_back( la.P1() );
-			Points.push_back( la.P2() );
-			MakeUnique( Points );
-			return;
-		}
+	double Cross = da*db;
+	double Offset = (ob - oa)*da;
 
-		if ( on_segment( la.P1(), lb ) )
-			Points.push_back( la.P1() );
+	if ( abs( Cross ) < LEPSILON )
+	{
+		if ( abs( Offset ) < LEPSILON ) //if colinear
+			return Overlap( oa, da, ob, db );
 
-		if ( on_segment( la.P2(), lb ) )
-			Points.push_back( la.P2() );
+		return Result;
+	}
 
-		if ( on_segment( lb.P1(), la ) )
-			Points.push_back( lb.P1() );
+	//math trick db cross db == 0, which is a single scalar in 2D
+	//crossing both sides with vector db gives
+	sa = ((ob - oa)*db) / Cross;
 
-		if ( on_segment( lb.P2(), la ) )
-			Points.push_back( lb.P2() );
+	//crossing both sides with vector da gives
+	sb = Offset / Cross;
 
-		MakeUnique( Points );
-		return;
+	if ( sa > -LEPSILON && sa < 1 + LEPSILON &&
+		 sb > -LEPSILON && sb < 1 + LEPSILON )
+	{
+		Result.Type = eIntersectionType::POINT;
+		Result.P1 = oa + da * sa;
 	}
 
-	if ( abs( da*db ) < LEPSILON && abs( (ob - oa)*da ) > LEPSILON )
+	return Result;
+}
+
+void
+Intersect( const double* x,
+		   const double* y,
+		   size_t Count,
+		   const CLine2D& lb,
+		   sIntersection* Results )
+{
+	// Parallel segments and the tail go through the scalar test
+	auto Scalar = [&]( size_t i )
 	{
-		MakeUnique( Points );
-		return;
-	}
+		Results[i] = Intersect( CLine2D( { x[i], y[i] }, { x[i + 1], y[i + 1] } ), lb );
+	};
 
-	//math trick db cross db == 0, which is a single scalar in 2D
-	//crossing both sides with vector db gives
-	sa = ((ob - oa)*db) / (da*db);
+	size_t i = 0;
 
-	//crossing both sides with vector da gives
-	sb = ((oa - ob)*da) / (db*da);
+#ifdef __AVX2__
+	const CVector2D& ob = lb.P1();
+	const CVector2D db = lb.P2() - lb.P1();
 
-	if ( (0 < sa || abs( sa ) < LEPSILON) && (sa < 1 || abs( sa - 1 ) < LEPSILON) &&
-		 (0 < sb || abs( sb ) < LEPSILON) && (sb < 1 || abs( sb - 1 ) < LEPSILON) )
+	auto Crossing = [&]( size_t i,
+						 double sa )
+	{
+		Results[i] = sIntersection();
+		Results[i].Type = eIntersectionType::POINT;
+		Results[i].P1 = CVector2D( x[i] + (x[i + 1] - x[i]) * sa, y[i] + (y[i + 1] - y[i]) * sa );
+	};
+
+	const __m256d obx = _mm256_set1_pd( ob.x );
+	const __m256d oby = _mm256_set1_pd( ob.y );
+	const __m256d dbx = _mm256_set1_pd( db.x );
+	const __m256d dby = _mm256_set1_pd( db.y );
+	const __m256d Lower = _mm256_set1_pd( -LEPSILON );
+	const __m256d Upper = _mm256_set1_pd( 1 + LEPSILON );
+	const __m256d Sign = _mm256_set1_pd( -0.0 );
+
+	for ( ; i + 4 <= Count; i += 4 )
 	{
-		Points.push_back( oa + da * sa );
+		__m256d oax = _mm256_loadu_pd( x + i );
+		__m256d oay = _mm256_loadu_pd( y + i );
+		__m256d dax = _mm256_sub_pd( _mm256_loadu_pd( x + i + 1 ), oax );
+		__m256d day = _mm256_sub_pd( _mm256_loadu_pd( y + i + 1 ), oay );
+		__m256d wx = _mm256_sub_pd( obx, oax );
+		__m256d wy = _mm256_sub_pd( oby, oay );
+
+		__m256d Cross = _mm256_sub_pd( _mm256_mul_pd( dax, dby ), _mm256_mul_pd( day, dbx ) );
+		__m256d Offset = _mm256_sub_pd( _mm256_mul_pd( wx, day ), _mm256_mul_pd( wy, dax ) );
+		__m256d Along = _mm256_sub_pd( _mm256_mul_pd( wx, dby ), _mm256_mul_pd( wy, dbx ) );
+
+		__m256d sa = _mm256_div_pd( Along, Cross );
+		__m256d sb = _mm256_div_pd( Offset, Cross );
+
+		__m256d Parallel = _mm256_cmp_pd( _mm256_andnot_pd( Sign, Cross ), _mm256_set1_pd( LEPSILON ), _CMP_LT_OQ );
+		__m256d Hit = _mm256_and_pd(
+			_mm256_and_pd( _mm256_cmp_pd( sa, Lower, _CMP_GT_OQ ), _mm256_cmp_pd( sa, Upper, _CMP_LT_OQ ) ),
+			_mm256_and_pd( _mm256_cmp_pd( sb, Lower, _CMP_GT_OQ ), _mm256_cmp_pd( sb, Upper, _CMP_LT_OQ ) ) );
+
+		int ParallelMask = _mm256_movemask_pd( Parallel );
+		int HitMask = _mm256_movemask_pd( Hit ) & ~ParallelMask;
+
+		alignas(32) double t[4];
+		_mm256_store_pd( t, sa );
+
+		for ( int k = 0; k < 4; ++k )
+		{
+			if ( ParallelMask & (1 << k) )
+				Scalar( i + k );
+			else if ( HitMask & (1 << k) )
+				Crossing( i + k, t[k] );
+			else
+				Results[i + k] = sIntersection();
+		}
 	}
+#endif
 
-	MakeUnique( Points );
-	return;
+	for ( ; i < Count; ++i )
+		Scalar( i );
 }
 
 CLine2D::CLine2D() :
@@ -219,3 +293,35 @@ CLine2D::DistanceTo( const CPoint2D& Point ) const
 
 	return Result;
 }
+
+void
+CLine2D::DistancesTo( const double* x,
+					  const double* y,
+					  size_t Count,
+					  double* Distances ) const
+{
+	CVector2D v1 = P2() - P1();
+	v1.Normalize();
+
+	double l = (P1() - P2()).Length();
+
+	for ( size_t i = 0; i < Count; ++i )
+	{
+		double dx = x[i] - mp1.x;
+		double dy = y[i] - mp1.y;
+
+		double Result = abs( dx * v1.y - dy * v1.x );
+
+		// Near the line but beyond an end, the distance to the nearer end
+		if ( Result < EPSILON )
+		{
+			double l1 = sqrt( dx * dx + dy * dy );
+			double l2 = sqrt( (x[i] - mp2.x) * (x[i] - mp2.x) + (y[i] - mp2.y) * (y[i] - mp2.y) );
+
+			if ( l1 > l || l2 > l )
+				Result = (std::min)( l1, l2 );
+		}
+
+		Distances[i] = Result;
+	}
+}
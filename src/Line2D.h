@@ -5,7 +5,8 @@
 #pragma once
 
 #include "Point2D.h"
-#include "Vector2D.h"
+#include "Vector2d.h"
+#include "Enums.h"
 
 #include <vector>
 
@@ -17,6 +18,12 @@ public:
 	virtual ~CLine2D() {};
 
 	double DistanceTo( const CPoint2D& Point ) const;
+
+	// DistanceTo for the points (x[i], y[i]), normalising the line once
+	void DistancesTo( const double* x,
+					  const double* y,
+					  size_t Count,
+					  double* Distances ) const;
 	const CVector2D& Vector() const
 	{
 		return mVector;
@@ -58,8 +65,23 @@ private:
 	double mSlope;
 };
 
+// Two segments meet in nothing, a point (P1) or an overlap (P1 to P2)
+struct sIntersection
+{
+	eIntersectionType Type = eIntersectionType::NONE;
+	CPoint2D P1;
+	CPoint2D P2;
+};
+
 bool Colinear( const CLine2D& la,
 			   const CLine2D& lb );
-void Intersect( const CLine2D& la, 
+sIntersection Intersect( const CLine2D& la, 
+						 const CLine2D& lb );
+
+// lb against the Count segments of the polyline (x[i], y[i]) to
+// (x[i + 1], y[i + 1]), one result per segment.  Vectorised with AVX2.
+void Intersect( const double* x,
+				const double* y,
+				size_t Count,
 				const CLine2D& lb,
-				std::vector<CVector2D>& Points );
+				sIntersection* Results );
@@ -0,0 +1,532 @@
+// LoadTable.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "LoadTable.h"
+
+#include "Constants.h"
+#include "Edge.h"
+#include "Line2D.h"
+#include "Vector2d.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+// Splits an anticlockwise simple polygon into triangles by cutting ears
+static void
+Triangulate( std::vector<CPoint2D> Points,
+			 std::vector<std::vector<CPoint2D>>& Parts )
+{
+	while ( Points.size() > 3 )
+	{
+		size_t n = Points.size();
+		bool Cut = false;
+
+		for ( size_t i = 0; i < n && !Cut; ++i )
+		{
+			const CPoint2D& a = Points[(i + n - 1) % n];
+			const CPoint2D& b = Points[i];
+			const CPoint2D& c = Points[(i + 1) % n];
+
+			double Turn = (b - a) * (c - b);
+
+			// A straight corner adds no area, a reflex one is no ear
+			if ( Turn < -EPSILON )
+				continue;
+
+			bool Empty = true;
+
+			for ( size_t k = 0; k < n && Empty && Turn > EPSILON; ++k )
+			{
+				const CPoint2D& p = Points[k];
+
+				if ( k == i || k == (i + n - 1) % n || k == (i + 1) % n )
+					continue;
+
+				Empty = !((b - a) * (p - a) >= 0 && (c - b) * (p - b) >= 0 && (a - c) * (p - c) >= 0);
+			}
+
+			if ( !Empty )
+				continue;
+
+			if ( Turn > EPSILON )
+				Parts.push_back( { a, b, c } );
+
+			Points.erase( Points.begin() + i );
+			Cut = true;
+		}
+
+		if ( !Cut )
+			return;
+	}
+
+	if ( Points.size() == 3 )
+		Parts.push_back( Points );
+}
+
+// Area and centroid of the part of Points inside the convex anticlockwise
+// Part.  Returns false if nothing is inside.
+static bool
+ClipArea( const CPoint2D* Points,
+		  size_t Count,
+		  const std::vector<CPoint2D>& Part,
+		  double& A,
+		  CPoint2D& c )
+{
+	// Every line of the part adds at most a point per edge it crosses, the
+	// stack buffers do for all but very large pieces
+	size_t Lines = Part.size();
+	size_t Bound = Count * (Lines + 1) + Lines * (Lines + 1) / 2;
+
+	CPoint2D Stack[2][CPoly2D::kClipCapacity];
+	std::vector<CPoint2D> Heap;
+
+	CPoint2D* Buffer[2] = { Stack[0], Stack[1] };
+	size_t Capacity = CPoly2D::kClipCapacity;
+
+	if ( Bound > Capacity )
+	{
+		Heap.resize( 2 * Bound );
+		Buffer[0] = &Heap[0];
+		Buffer[1] = &Heap[Bound];
+		Capacity = Bound;
+	}
+
+	const CPoint2D* Clipped = Points;
+
+	for ( size_t i = 0; i < Lines && Count; ++i )
+	{
+		CLine2D Line( Part[i], Part[(i + 1) % Lines] );
+
+		Count = CPoly2D::ClipConvex( Clipped, Count, Line, Buffer[i % 2], Capacity );
+
+		if ( Count == CPoly2D::kClipFailed )
+			return false;
+
+		Clipped = Buffer[i % 2];
+	}
+
+	if ( Count < 3 )
+		return false;
+
+	A = CPoly2D::Area( Clipped, Count );
+	if ( A <= 0 )
+		return false;
+
+	c = CPoly2D::Centroid( Clipped, Count );
+
+	return true;
+}
+
+CLoadTable::CLoadTable():
+	mUserLoads( 0 ),
+	mPlateLive( 0 ),
+	mPlateDead( 0 ),
+	mCalculated( false ),
+	mThreads( 0 )
+{
+}
+
+size_t
+CLoadTable::Add( eLoadType Type,
+				 const std::vector<CPoint2D>& Points,
+				 double Live,
+				 double Dead )
+{
+	// The rows have a column per load, a new one would not be in them
+	if ( mCalculated )
+		throw std::runtime_error( "Loads are added before BuildEdges" );
+
+	// The openings follow the user loads, they are added again with the edges
+	mLoads.resize( mUserLoads );
+	mLive.resize( mUserLoads );
+	mDead.resize( mUserLoads );
+
+	fAdd( Type, Points, Live, Dead );
+
+	return mUserLoads++;
+}
+
+void
+CLoadTable::fAdd( eLoadType Type,
+				  const std::vector<CPoint2D>& Points,
+				  double Live,
+				  double Dead )
+{
+	sLoad Load;
+	Load.Type = Type;
+	Load.Points = Points;
+
+	if ( Type == eLoadType::AREA && Points.size() > 2 )
+	{
+		std::vector<CPoint2D> Region = Points;
+
+		if ( CPoly2D::Area( Region.data(), Region.size() ) < 0 )
+			std::reverse( Region.begin(), Region.end() );
+
+		if ( CPoly2D::IsConvex( Region.data(), Region.size() ) )
+			Load.Parts.push_back( Region );
+		else
+			Triangulate( Region, Load.Parts );
+	}
+
+	mLoads.push_back( Load );
+	mLive.push_back( Live );
+	mDead.push_back( Dead );
+}
+
+void
+CLoadTable::SetMagnitude( size_t Load,
+						  double Live,
+						  double Dead )
+{
+	mLive[Load] = Live;
+	mDead[Load] = Dead;
+}
+
+void
+CLoadTable::SetOpenings( const std::vector<CPoly2D>& Openings )
+{
+	mLoads.resize( mUserLoads );
+	mLive.resize( mUserLoads );
+	mDead.resize( mUserLoads );
+
+	for ( const auto& Opening : Openings )
+	{
+		std::vector<CPoint2D> Points;
+		for ( size_t i = 0; i < Opening.GetNumPoints(); ++i )
+			Points.push_back( Opening.GetPoint( i ) );
+
+		fAdd( eLoadType::AREA, Points, -mPlateLive, -mPlateDead );
+	}
+}
+
+void
+CLoadTable::SetPlateLoad( double Live,
+						  double Dead )
+{
+	mPlateLive = Live;
+	mPlateDead = Dead;
+
+	for ( size_t p = mUserLoads; p < mLoads.size(); ++p )
+	{
+		mLive[p] = -Live;
+		mDead[p] = -Dead;
+	}
+}
+
+void
+CLoadTable::fCalculate( CEdge* Edge,
+						const CPoly2D& Outline,
+						double* Factors ) const
+{
+	size_t Count = mLoads.size();
+	std::fill( Factors, Factors + 3 * Count, 0.0 );
+
+	CPoint2D Buffer[2][CPoly2D::kClipCapacity];
+	std::vector<CPoint2D> Polygon;
+
+	const CPoint2D* Piece = Buffer[0];
+	size_t Size = Edge->GetTributaryArea( Outline, Buffer[0], Buffer[1], Polygon );
+
+	if ( Size == CPoly2D::kClipFailed )
+	{
+		Piece = Polygon.data();
+		Size = Polygon.size();
+	}
+
+	if ( Size < 3 )
+		return;
+
+	// The levers of the plate UDL: the distance from the edge and along it
+	// from its midpoint, left to right
+	CPoint2D p1 = Edge->GetPoint( 0 );
+	CPoint2D p2 = Edge->GetPoint( 1 );
+
+	if ( p1.x > p2.x )
+		std::swap( p1, p2 );
+
+	CVector2D v = p2 - p1;
+	v.Normalize();
+
+	CPoint2D Mid = (p1 + p2) / 2;
+
+	auto Add = [&]( size_t p,
+					const CPoint2D& q,
+					double Weight )
+	{
+		Factors[p] += Weight * Edge->Line.DistanceTo( q );
+		Factors[Count + p] += Weight * v.Dot( q - Mid );
+		Factors[2 * Count + p] += Weight;
+	};
+
+	// A load on the outline of the piece counts half, its displacement is
+	// the mean of both sides
+	auto Share = [&]( const CPoint2D& q ) -> double
+	{
+		if ( CPoly2D::PointOnPoly( Piece, Size, q ) > -1 )
+			return 0.5;
+
+		return CPoly2D::PointInPoly( Piece, Size, q ) ? 1.0 : 0.0;
+	};
+
+	for ( size_t p = 0; p < Count; ++p )
+	{
+		const sLoad& Load = mLoads[p];
+
+		switch ( Load.Type )
+		{
+		case eLoadType::AREA:
+		{
+			double A;
+			CPoint2D c;
+
+			for ( const auto& Part : Load.Parts )
+			{
+				if ( ClipArea( Piece, Size, Part, A, c ) )
+					Add( p, c, A );
+			}
+			break;
+		}
+		case eLoadType::POINT:
+			Add( p, Load.Points[0], Share( Load.Points[0] ) );
+			break;
+		case eLoadType::LINE:
+		{
+			// Cut the line where it crosses the piece, each stretch between
+			// cuts is in or out as a whole
+			const CPoint2D& a = Load.Points[0];
+			const CPoint2D& b = Load.Points[1];
+
+			CVector2D d = b - a;
+			double Length = d.Length();
+
+			if ( Length <= EPSILON )
+				break;
+
+			double Stack[2 * CPoly2D::kClipCapacity + 2];
+			std::vector<double> Heap;
+
+			double* t = Stack;
+			if ( Size > CPoly2D::kClipCapacity )
+			{
+				Heap.resize( 2 * Size + 2 );
+				t = Heap.data();
+			}
+
+			size_t Cuts = 0;
+			t[Cuts++] = 0;
+			t[Cuts++] = 1;
+
+			auto Cut = [&]( const CPoint2D& q )
+			{
+				t[Cuts++] = std::min( std::max( d.Dot( q - a ) / (Length * Length), 0.0 ), 1.0 );
+			};
+
+			CLine2D Line( a, b );
+
+			for ( size_t i = 0; i < Size; ++i )
+			{
+				sIntersection Hit = Intersect( Line, CLine2D( Piece[i], Piece[(i + 1) % Size] ) );
+
+				if ( Hit.Type != eIntersectionType::NONE )
+					Cut( Hit.P1 );
+				if ( Hit.Type == eIntersectionType::OVERLAP )
+					Cut( Hit.P2 );
+			}
+
+			std::sort( t, t + Cuts );
+
+			for ( size_t i = 1; i < Cuts; ++i )
+			{
+				double Stretch = (t[i] - t[i - 1]) * Length;
+
+				if ( Stretch <= EPSILON )
+					continue;
+
+				CPoint2D q = a + d * ((t[i] + t[i - 1]) / 2);
+				double Weight = Share( q );
+
+				if ( Weight > 0 )
+					Add( p, q, Weight * Stretch );
+			}
+			break;
+		}
+		}
+	}
+
+	if ( Edge->Type != eEdgeType::FREE &&
+		 Edge->Type != eEdgeType::SYMMETRY )
+	{
+		std::fill( Factors + Count, Factors + 3 * Count, 0.0 );
+	}
+}
+
+void
+CLoadTable::fCalculateAll( const std::vector<CEdge*>& Edges,
+						   const CPoly2D& Outline,
+						   double* Factors ) const
+{
+	const size_t kChunk = 256;
+
+	size_t Width = 3 * mLoads.size();
+	size_t Chunks = (Edges.size() + kChunk - 1) / kChunk;
+	std::atomic<size_t> Next( 0 );
+
+	auto Work = [&]()
+	{
+		for ( ;; )
+		{
+			size_t Chunk = Next++;
+			if ( Chunk >= Chunks )
+				break;
+
+			size_t Last = std::min( (Chunk + 1) * kChunk, Edges.size() );
+			for ( size_t i = Chunk * kChunk; i < Last; ++i )
+				fCalculate( Edges[i], Outline, Factors + i * Width );
+		}
+	};
+
+	unsigned Threads = mThreads > 0 ? static_cast<unsigned>(mThreads) : std::max( std::thread::hardware_concurrency(), 1u );
+
+	std::vector<std::thread> Workers;
+	for ( unsigned i = 1; i < Threads && i < Chunks; ++i )
+		Workers.push_back( std::thread( Work ) );
+
+	Work();
+
+	for ( auto& Worker : Workers )
+		Worker.join();
+}
+
+void
+CLoadTable::Clear()
+{
+	mRows.clear();
+	mCandidateRows.clear();
+	mCalculated = false;
+}
+
+void
+CLoadTable::Calculate( const std::vector<CEdge*>& Edges,
+					   const CPoly2D& Outline )
+{
+	mRows.clear();
+	mCalculated = true;
+
+	if ( mLoads.empty() )
+		return;
+
+	mRows.resize( 3 * mLoads.size() * Edges.size() );
+	fCalculateAll( Edges, Outline, mRows.data() );
+}
+
+void
+CLoadTable::Append( CEdge* Edge,
+					const CPoly2D& Outline )
+{
+	if ( mLoads.empty() )
+		return;
+
+	size_t Row = mRows.size();
+
+	mRows.resize( Row + 3 * mLoads.size() );
+	fCalculate( Edge, Outline, &mRows[Row] );
+}
+
+void
+CLoadTable::ClearCandidates()
+{
+	mCandidateRows.clear();
+}
+
+void
+CLoadTable::AppendCandidates( const std::vector<CEdge*>& Edges,
+							  const CPoly2D& Outline )
+{
+	std::vector<float> Factors;
+	GetCandidateFactors( Edges, Outline, Factors );
+
+	mCandidateRows.insert( mCandidateRows.end(), Factors.begin(), Factors.end() );
+}
+
+void
+CLoadTable::GetCandidateFactors( const std::vector<CEdge*>& Edges,
+								 const CPoly2D& Outline,
+								 std::vector<float>& Factors ) const
+{
+	size_t Count = mLoads.size();
+
+	Factors.clear();
+	if ( Count == 0 || Edges.empty() )
+		return;
+
+	std::vector<double> Rows( 3 * Count * Edges.size() );
+	fCalculateAll( Edges, Outline, Rows.data() );
+
+	// Candidates are internal edges, only the normal moment DOF is kept
+	Factors.resize( Count * Edges.size() );
+	for ( size_t i = 0; i < Edges.size(); ++i )
+	{
+		for ( size_t p = 0; p < Count; ++p )
+			Factors[Count * i + p] = static_cast<float>(Rows[3 * Count * i + p]);
+	}
+}
+
+void
+CLoadTable::Combine( size_t Row,
+					 double* Live,
+					 double* Dead ) const
+{
+	size_t Count = mLoads.size();
+
+	if ( Count == 0 || mRows.empty() )
+		return;
+
+	const double* Factors = &mRows[3 * Count * Row];
+
+	for ( size_t j = 0; j < 3; ++j )
+	{
+		for ( size_t p = 0; p < Count; ++p )
+		{
+			Live[j] += mLive[p] * Factors[j * Count + p];
+			Dead[j] += mDead[p] * Factors[j * Count + p];
+		}
+	}
+}
+
+double
+CLoadTable::GetWork( size_t Row,
+					 double Lambda ) const
+{
+	size_t Count = mLoads.size();
+	double Result = 0;
+
+	if ( Count == 0 || mRows.empty() )
+		return Result;
+
+	const double* Factors = &mRows[3 * Count * Row];
+
+	for ( size_t p = 0; p < Count; ++p )
+		Result += (Lambda * mLive[p] + mDead[p]) * Factors[p];
+
+	return Result;
+}
+
+double
+CLoadTable::GetCandidateWork( const float* Factors,
+							  double Lambda ) const
+{
+	size_t Count = mLoads.size();
+	double Result = 0;
+
+	if ( !Factors )
+		return Result;
+
+	for ( size_t p = 0; p < Count; ++p )
+		Result += (Lambda * mLive[p] + mDead[p]) * Factors[p];
+
+	return Result;
+}
@@ -0,0 +1,111 @@
+// LoadTable.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include "Point2D.h"
+#include "Poly2D.h"
+#include "Enums.h"
+
+#include <vector>
+#include <cstddef>
+
+class CEdge;
+
+// Loads besides the UDL over the whole plate: area loads over a region,
+// point loads and line loads.  The work of every load at unit magnitude in
+// the DOFs of every edge is calculated once, from the part of the plate
+// above the edge, and kept in dense rows.  The live and dead magnitudes
+// only weigh those factors, changing them redoes no geometry.
+class CLoadTable
+{
+public:
+	CLoadTable();
+	virtual ~CLoadTable() {};
+
+	// Points are the region, the point or the two ends of the line.  Loads
+	// are added before the edges are built, Add throws std::runtime_error
+	// once the rows are calculated.  Clear drops the rows again.
+	size_t Add( eLoadType Type,
+				const std::vector<CPoint2D>& Points,
+				double Live,
+				double Dead );
+	void SetMagnitude( size_t Load,
+					   double Live,
+					   double Dead );
+	size_t GetCount() const { return mLoads.size(); };
+
+	// The openings carry the plate UDL taken off again
+	void SetOpenings( const std::vector<CPoly2D>& Openings );
+	void SetPlateLoad( double Live,
+					   double Dead );
+
+	void Clear();
+
+	// Threads calculating the rows, 0 uses a thread per hardware thread
+	void SetThreads( int Threads ) { mThreads = Threads; };
+
+	// Rows of the edges in order, edge i gets row i
+	void Calculate( const std::vector<CEdge*>& Edges,
+					const CPoly2D& Outline );
+	void Append( CEdge* Edge,
+				 const CPoly2D& Outline );
+
+	// Single precision factors of the normal moment DOF for compact
+	// candidates, GetCount() per candidate.  AppendCandidates keeps them here
+	// in candidate order, the streamed pool stores GetCandidateFactors.
+	void ClearCandidates();
+	void AppendCandidates( const std::vector<CEdge*>& Edges,
+						   const CPoly2D& Outline );
+	void GetCandidateFactors( const std::vector<CEdge*>& Edges,
+							  const CPoly2D& Outline,
+							  std::vector<float>& Factors ) const;
+	const float* GetCandidateRows() const { return mCandidateRows.empty() ? nullptr : mCandidateRows.data(); };
+
+	// Adds the live and dead load in the three DOFs of row Row
+	void Combine( size_t Row,
+				  double* Live,
+				  double* Dead ) const;
+
+	// Work in the normal moment DOF at load factor Lambda
+	double GetWork( size_t Row,
+					double Lambda ) const;
+	double GetCandidateWork( const float* Factors,
+							 double Lambda ) const;
+
+protected:
+	struct sLoad
+	{
+		eLoadType Type;
+		std::vector<CPoint2D> Points;
+
+		// Convex anticlockwise parts of an area
+		std::vector<std::vector<CPoint2D>> Parts;
+	};
+
+	std::vector<sLoad> mLoads;
+	std::vector<double> mLive;
+	std::vector<double> mDead;
+	size_t mUserLoads;
+
+	double mPlateLive;
+	double mPlateDead;
+
+	// Load p in DOF j of row i at [(3 * i + j) * GetCount() + p]
+	std::vector<double> mRows;
+	std::vector<float> mCandidateRows;
+	bool mCalculated;
+	int mThreads;
+
+	void fAdd( eLoadType Type,
+			   const std::vector<CPoint2D>& Points,
+			   double Live,
+			   double Dead );
+	void fCalculate( CEdge* Edge,
+					 const CPoly2D& Outline,
+					 double* Factors ) const;
+	void fCalculateAll( const std::vector<CEdge*>& Edges,
+						const CPoly2D& Outline,
+						double* Factors ) const;
+};
@@ -7,23 +7,17 @@
 #include "Constants.h"
 #include "Domain.h"
 
+#include <cstdio>
+
 void
 CMosekDLOSolver::fGetColumnSolution()
 {
-	if ( mResultArray )
-	{
-		delete[]mResultArray;
-		mResultArray = nullptr;
-	}
-
-	mResultArray = new double[mNumDisp + mNumYEdges * 2];
-
-	mSize = mNumDisp + mNumYEdges * 2;
+	fResizeResult( mNumDisp + mNumYEdges * 2 );
 
 	if ( mResultArray )
 	{
 		MSK_getxx( mCurrentTask,
-				   MSK_SOL_BAS,    // Request the basic solution. 
+				   mSolution,
 				   mResultArray );
 	}
 }
@@ -44,10 +38,8 @@ CMosekDLOSolver::fSolve( double& Objective )
 	mfD.clear();
 
 	mfD.resize( mNumDOF, 0.0 );
-	mDomain->fCalculateUDL( mfD, mDomain->mDeadLoad );
-
 	mfL.resize( mNumDOF, 0.0 );
-	mDomain->fCalculateUDL( mfL, mDomain->mLiveLoad );
+	mDomain->fCalculateLoads( mActiveEdges, mfL, mfD );
 	
 	mPtrb.resize( numvar, -1 );
 	mPtre.resize( numvar, -1 );
@@ -62,6 +54,22 @@ CMosekDLOSolver::fSolve( double& Objective )
 	mCurrentTask = fBuildModel( env );
 	MSK_putintparam( mCurrentTask, MSK_IPAR_NUM_THREADS, 4 );
 
+	MSK_putdouparam( mCurrentTask, MSK_DPAR_INTPNT_TOL_REL_GAP, mTolerance );
+	MSK_putdouparam( mCurrentTask, MSK_DPAR_INTPNT_TOL_PFEAS, mTolerance );
+	MSK_putdouparam( mCurrentTask, MSK_DPAR_INTPNT_TOL_DFEAS, mTolerance );
+
+	// Skip the basis identification while the LP is solved loose
+	if ( fIsTight() )
+	{
+		MSK_putintparam( mCurrentTask, MSK_IPAR_INTPNT_BASIS, MSK_BI_ALWAYS );
+		mSolution = MSK_SOL_BAS;
+	}
+	else
+	{
+		MSK_putintparam( mCurrentTask, MSK_IPAR_INTPNT_BASIS, MSK_BI_NEVER );
+		mSolution = MSK_SOL_ITR;
+	}
+
 	MSKrescodee trmcode;
 
 	/* Run optimizer */
@@ -78,7 +86,7 @@ CMosekDLOSolver::fSolve( double& Objective )
 
 		if ( r == MSK_RES_OK )
 			r = MSK_getsolsta( mCurrentTask,
-							   MSK_SOL_BAS,
+							   mSolution,
 							   &solsta );
 		switch ( solsta )
 		{
@@ -88,14 +96,14 @@ CMosekDLOSolver::fSolve( double& Objective )
 			fGetColumnSolution();
 
 			MSK_getprimalobj( mCurrentTask,
-							  MSK_SOL_BAS,    // Request the basic solution. 
+							  mSolution,
 							  &Objective );
 
-			Result = new double[numcon];
+			Result = mArena.Allocate<double>( numcon );
 			if ( Result )
 			{
 				MSK_gety( mCurrentTask,
-						  MSK_SOL_BAS,    // Request the basic solution. 
+						  mSolution,
 						  Result );
 
 				/*printf( "Optimal dual solution\n" );
@@ -253,26 +261,28 @@ CMosekDLOSolver::fBuildModel( MSKenv_t env )
 void 
 CMosekDLOSolver::fCalculateCompatibilityMatrix( MSKtask_t task )
 {
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
-
-	std::vector<double> RowVector;
-	std::vector<std::vector<double>> Matrix;
-	RowVector.resize( 3, 0.0 );
-	Matrix.resize( 6, RowVector );
+	std::vector<CEdge*>& Edges = mActiveEdges;
+	CEdgeAssembly& Assembly = mAssembly;
 
-	int n1, n2;
 	size_t ColIndex = 0;
 
 	int Count = 0;
 
+	Assembly.Clear();
+
 	for ( auto& Edge : Edges )
 	{
-		if ( Edge->Added &&
-			 Edge->Type != eEdgeType::FREE &&
-			 Edge->Type != eEdgeType::SIMPLE_ANCHORED )
-			++Count;
+		if ( Edge->Added )
+		{
+			Assembly.Add( Edge );
+
+			if ( CEdgeAssembly::IsYielding( Edge->Class() ) )
+				++Count;
+		}
 	}
 
+	Assembly.Assemble();
+
 	mObjP.resize( 2 * Count );
 
 	int NodeSize = static_cast<int>(mDomain->mNodes.size());
@@ -282,30 +292,13 @@ CMosekDLOSolver::fCalculateCompatibilityMatrix( MSKtask_t task )
 	Count = 1;
 	int YieldingCount = 1;
 
-	std::array<size_t, 3> an1 = { 0,0,0 };
-	std::array<size_t, 3> an2 = { 0,0,0 };
-
 	for ( int i = 0; i < Edges.size(); ++i )
 	{
 		if ( Edges[i]->Added )
 		{
-			n1 = static_cast<int>(Edges[i]->N1);
-			n2 = static_cast<int>(Edges[i]->N2);
-
-			an1 = { 0,1,2 };
-			an2 = { 3,4,5 };
-
-			if ( n1 > n2 )
-			{
-				std::swap( n1, n2 );
-				an1 = { 3,4,5 };
-				an2 = { 0,1,2 };
-			}
-
-			Edges[i]->GetCompatibilityMatrix( Matrix, true );
+			bool Yielding = CEdgeAssembly::IsYielding( Edges[i]->Class() );
 
-			if ( Edges[i]->Type != eEdgeType::FREE &&
-				 Edges[i]->Type != eEdgeType::SIMPLE_ANCHORED )
+			if ( Yielding )
 			{
 				mObjP[2 * YieldingCount - 2] = Edges[i]->MpPos*Edges[i]->Length;
 				mObjP[2 * YieldingCount - 1] = Edges[i]->MpNeg*Edges[i]->Length;
@@ -317,83 +310,14 @@ CMosekDLOSolver::fCalculateCompatibilityMatrix( MSKtask_t task )
 			{
 				col1 = static_cast<int>( mVal.size() );
 
-				if ( j == 0 )
-				{
-					if ( abs( Matrix[0][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an1[0]][j] );
-						mSub.push_back( 3 * n1 - 3 );
-					}
-
-					if ( abs( Matrix[1][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an1[1]][j] );
-						mSub.push_back( 3 * n1 - 2 );
-					}
-
-					if ( abs( Matrix[3][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an2[0]][j] );
-						mSub.push_back( 3 * n2 - 3 );
-					}
-
-					if ( abs( Matrix[4][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an2[1]][j] );
-						mSub.push_back( 3 * n2 - 2 );
-					}
-				}
-				else if ( j == 1 )
-				{
-					if ( abs( Matrix[0][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an1[0]][j] );
-						mSub.push_back( 3 * n1 - 3 );
-					}
-
-					if ( abs( Matrix[1][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an1[1]][j] );
-						mSub.push_back( 3 * n1 - 2 );
-					}
-
-					if ( abs( Matrix[2][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an1[2]][j] );
-						mSub.push_back( 3 * n1 - 1 );
-					}
-
-					if ( abs( Matrix[3][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an2[0]][j] );
-						mSub.push_back( 3 * n2 - 3 );
-					}
-
-					if ( abs( Matrix[4][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an2[1]][j] );
-						mSub.push_back( 3 * n2 - 2 );
-					}
-
-					if ( abs( Matrix[5][j] ) > 0 )
-					{
-						mVal.push_back( Matrix[an2[2]][j] );
-						mSub.push_back( 3 * n2 - 1 );
-					}
-				}
-				else if ( j == 2 )
-				{
-					mVal.push_back( Matrix[an1[2]][j] );
-					mSub.push_back( 3 * n1 - 1 );
-
-					mVal.push_back( Matrix[an2[2]][j] );
-					mSub.push_back( 3 * n2 - 1 );
-
-				}
+				const int* Rows = Assembly.GetRows( ColIndex );
+				const double* Values = Assembly.GetValues( ColIndex );
 
+				mSub.insert( mSub.end(), Rows, Rows + Assembly.GetCount( ColIndex ) );
+				mVal.insert( mVal.end(), Values, Values + Assembly.GetCount( ColIndex ) );
 
-				if ( Edges[i]->Type != eEdgeType::FREE &&
-					 Edges[i]->Type != eEdgeType::SIMPLE_ANCHORED )
+				// The yield row of an edge holds its normal moment, column 0
+				if ( Yielding && j == 0 )
 				{
 					mVal.push_back( -1 );
 					mSub.push_back( Count - 1 + NodeSize * 3 );
@@ -433,7 +357,7 @@ CMosekDLOSolver::fCalculatePlasticMultiplierTerms( MSKtask_t task )
 
 	size_t ColumnIndex = mNumDisp;
 	int Row = 3 * static_cast<int>(mDomain->mNodes.size());
-	std::vector<CEdge*>& Edges = mDomain->mEdges;
+	std::vector<CEdge*>& Edges = mActiveEdges;
 
 	int Count = 1;
 
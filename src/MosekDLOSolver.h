@@ -11,7 +11,8 @@ class CMosekDLOSolver : public CDLOSolver
 {
 public:
 	CMosekDLOSolver():
-		mCurrentTask(nullptr)
+		mCurrentTask(nullptr),
+		mSolution(MSK_SOL_BAS)
 	{
 	};
 
@@ -21,6 +22,8 @@ public:
 
 protected:
 	MSKtask_t mCurrentTask;
+	// Interior point solution while the tolerance is loose, basic otherwise
+	MSKsoltypee mSolution;
 	double* fSolve( double& Objective ) override;
 	void fGetColumnSolution() override;
 
@@ -0,0 +1,307 @@
+// MultilevelDLO.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "MultilevelDLO.h"
+
+#include "Domain.h"
+#include "DLOSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+double
+CMultilevelDLO::Solve( CDomain* Domain,
+					   double Size )
+{
+	double Result = 0;
+
+	mStats.clear();
+
+	for ( int Level = 0; Level < mLevels; ++Level )
+	{
+		auto Start = std::chrono::steady_clock::now();
+
+		Domain->Discretize( Size );
+		Domain->BuildEdges();
+
+		size_t Seeded = 0;
+
+		if ( Level > 0 )
+		{
+			Seeded = fSeedEdges( Domain, Size );
+
+			std::vector<double> Forces;
+			fInterpolateForces( Domain, Forces );
+			mSolver->SetInitialForces( Forces, Result );
+		}
+
+		Result = mSolver->Solve( Domain );
+
+		if ( Level + 1 < mLevels )
+			fKeepLevel( Domain );
+
+		std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+		sLevelStats Stats;
+		Stats.Size = Size;
+		Stats.Nodes = Domain->GetNodes().size();
+		Stats.Edges = Domain->GetEdges().size();
+		Stats.Seeded = Seeded;
+		Stats.InitialAdmitted = mSolver->GetInitialAdmitted();
+		Stats.Iterations = static_cast<int>(mSolver->GetIterationStats().size());
+		Stats.Lambda = Result;
+		Stats.Time = Elapsed.count();
+
+		mStats.push_back( Stats );
+
+		Size /= 2;
+	}
+
+	return Result;
+}
+
+void
+CMultilevelDLO::fKeepLevel( CDomain* Domain )
+{
+	// Yield lines come as phin, phit, d, plastic multiplier and the two
+	// points, boundary edges report a zero multiplier
+	std::vector<double> Data = mSolver->GetEdgeData();
+
+	mLines.clear();
+	for ( size_t i = 0; i + 8 <= Data.size(); i += 8 )
+	{
+		if ( Data[i + 3] > 0 )
+			mLines.push_back( { { Data[i + 4], Data[i + 5] }, { Data[i + 6], Data[i + 7] } } );
+	}
+
+	mPoints.clear();
+	for ( const auto& Node : Domain->GetNodes() )
+		mPoints.push_back( Node.Point );
+
+	mTriangles = Domain->GetTriangles();
+	mForces = mSolver->GetForces();
+}
+
+size_t
+CMultilevelDLO::fSeedEdges( CDomain* Domain,
+							double Size )
+{
+	// An edge lies on a yield line when both its nodes are within a quarter
+	// of the spacing of the line and it runs along it
+	const double Tolerance = 0.25 * Size;
+	const double kParallel = 0.25;
+
+	const std::vector<CNode>& Nodes = Domain->GetNodes();
+
+	// Yield lines near every node
+	std::vector<std::vector<uint32_t>> NodeLines( Nodes.size() );
+
+	for ( size_t l = 0; l < mLines.size(); ++l )
+	{
+		const CPoint2D& P1 = mLines[l].P1;
+		double dx = mLines[l].P2.x - P1.x;
+		double dy = mLines[l].P2.y - P1.y;
+		double Length2 = dx * dx + dy * dy;
+
+		if ( Length2 <= 0 )
+			continue;
+
+		for ( size_t n = 0; n < Nodes.size(); ++n )
+		{
+			const CPoint2D& Point = Nodes[n].Point;
+
+			double t = ((Point.x - P1.x) * dx + (Point.y - P1.y) * dy) / Length2;
+			t = std::min( std::max( t, 0.0 ), 1.0 );
+
+			double ex = Point.x - (P1.x + t * dx);
+			double ey = Point.y - (P1.y + t * dy);
+
+			if ( ex * ex + ey * ey <= Tolerance * Tolerance )
+				NodeLines[n].push_back( static_cast<uint32_t>(l) );
+		}
+	}
+
+	// Both nodes near the same yield line and the edge along it
+	auto OnYieldLine = [&]( size_t N1, size_t N2 ) -> bool
+	{
+		const std::vector<uint32_t>& Lines1 = NodeLines[N1 - 1];
+		const std::vector<uint32_t>& Lines2 = NodeLines[N2 - 1];
+
+		CVector2D v = Nodes[N2 - 1].Point - Nodes[N1 - 1].Point;
+		double Length = v.Length();
+
+		if ( Length <= 0 )
+			return false;
+
+		for ( uint32_t l : Lines1 )
+		{
+			if ( std::find( Lines2.begin(), Lines2.end(), l ) == Lines2.end() )
+				continue;
+
+			double dx = mLines[l].P2.x - mLines[l].P1.x;
+			double dy = mLines[l].P2.y - mLines[l].P1.y;
+			double Sine = std::abs( v.x * dy - v.y * dx ) / (Length * std::sqrt( dx * dx + dy * dy ));
+
+			if ( Sine <= kParallel )
+				return true;
+		}
+
+		return false;
+	};
+
+	size_t Result = 0;
+
+	for ( CEdge* Edge : Domain->GetEdges() )
+	{
+		if ( !Edge->Removeable || Edge->Added )
+			continue;
+
+		if ( OnYieldLine( Edge->N1, Edge->N2 ) )
+		{
+			Edge->Added = true;
+			++Result;
+		}
+	}
+
+	// Compact and streamed candidates are not in the edge list
+	Result += Domain->AddCandidates( OnYieldLine );
+
+	return Result;
+}
+
+void
+CMultilevelDLO::fInterpolateForces( CDomain* Domain,
+									std::vector<double>& Forces )
+{
+	const double kInside = -1e-9;
+
+	const std::vector<CNode>& Nodes = Domain->GetNodes();
+
+	Forces.clear();
+	if ( mTriangles.empty() || mForces.size() != 3 * mPoints.size() )
+		return;
+
+	CPoint2D Min = mPoints[0], Max = mPoints[0];
+	for ( const auto& Point : mPoints )
+	{
+		Min.x = std::min( Min.x, Point.x );
+		Min.y = std::min( Min.y, Point.y );
+		Max.x = std::max( Max.x, Point.x );
+		Max.y = std::max( Max.y, Point.y );
+	}
+
+	// Grid of about one coarse triangle per cell, a triangle is listed in
+	// every cell its bounding box overlaps
+	size_t Side = std::max<size_t>( 1, static_cast<size_t>(std::sqrt( static_cast<double>(mTriangles.size()) )) );
+	double Width = std::max( Max.x - Min.x, Max.y - Min.y ) / Side;
+	if ( Width <= 0 )
+		Width = 1;
+
+	auto Cell = [&]( double v, double Origin ) -> size_t
+	{
+		double c = std::floor( (v - Origin) / Width );
+		return static_cast<size_t>(std::min( std::max( c, 0.0 ), static_cast<double>(Side - 1) ));
+	};
+
+	std::vector<size_t> Start( Side * Side + 1, 0 );
+	std::vector<uint32_t> Cells;
+
+	for ( int Pass = 0; Pass < 2; ++Pass )
+	{
+		std::vector<size_t> Next( Start.begin(), Start.end() - 1 );
+
+		for ( size_t t = 0; t < mTriangles.size(); ++t )
+		{
+			const CPoint2D& a = mPoints[mTriangles[t][0] - 1];
+			const CPoint2D& b = mPoints[mTriangles[t][1] - 1];
+			const CPoint2D& c = mPoints[mTriangles[t][2] - 1];
+
+			size_t x0 = Cell( std::min( { a.x, b.x, c.x } ), Min.x ), x1 = Cell( std::max( { a.x, b.x, c.x } ), Min.x );
+			size_t y0 = Cell( std::min( { a.y, b.y, c.y } ), Min.y ), y1 = Cell( std::max( { a.y, b.y, c.y } ), Min.y );
+
+			for ( size_t y = y0; y <= y1; ++y )
+			{
+				for ( size_t x = x0; x <= x1; ++x )
+				{
+					if ( Pass == 0 )
+						++Start[y * Side + x + 1];
+					else
+						Cells[Next[y * Side + x]++] = static_cast<uint32_t>(t);
+				}
+			}
+		}
+
+		if ( Pass == 0 )
+		{
+			for ( size_t i = 1; i < Start.size(); ++i )
+				Start[i] += Start[i - 1];
+
+			Cells.resize( Start.back() );
+		}
+	}
+
+	Forces.assign( 3 * Nodes.size(), 0.0 );
+
+	for ( size_t n = 0; n < Nodes.size(); ++n )
+	{
+		const CPoint2D& p = Nodes[n].Point;
+		size_t Index = Cell( p.y, Min.y ) * Side + Cell( p.x, Min.x );
+
+		bool Found = false;
+
+		for ( size_t k = Start[Index]; k < Start[Index + 1] && !Found; ++k )
+		{
+			const std::array<size_t, 3>& Triangle = mTriangles[Cells[k]];
+
+			const CPoint2D& a = mPoints[Triangle[0] - 1];
+			const CPoint2D& b = mPoints[Triangle[1] - 1];
+			const CPoint2D& c = mPoints[Triangle[2] - 1];
+
+			double Det = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+			if ( Det == 0 )
+				continue;
+
+			double wa = ((b.x - p.x) * (c.y - p.y) - (c.x - p.x) * (b.y - p.y)) / Det;
+			double wb = ((c.x - p.x) * (a.y - p.y) - (a.x - p.x) * (c.y - p.y)) / Det;
+			double wc = 1 - wa - wb;
+
+			if ( wa < kInside || wb < kInside || wc < kInside )
+				continue;
+
+			const double Weights[3] = { wa, wb, wc };
+
+			for ( size_t j = 0; j < 3; ++j )
+			{
+				for ( size_t Row = 0; Row < 3; ++Row )
+					Forces[3 * n + Row] += Weights[j] * mForces[3 * Triangle[j] - 3 + Row];
+			}
+
+			Found = true;
+		}
+
+		if ( Found )
+			continue;
+
+		// Outside the coarse mesh, along a curved or cut boundary: the
+		// nearest coarse node
+		size_t Nearest = 0;
+		double Distance = std::numeric_limits<double>::max();
+
+		for ( size_t i = 0; i < mPoints.size(); ++i )
+		{
+			double d = (mPoints[i] - p).LengthSquared();
+			if ( d < Distance )
+			{
+				Distance = d;
+				Nearest = i;
+			}
+		}
+
+		for ( size_t Row = 0; Row < 3; ++Row )
+			Forces[3 * n + Row] = mForces[3 * Nearest + Row];
+	}
+}
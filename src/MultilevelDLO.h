@@ -0,0 +1,76 @@
+// MultilevelDLO.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include "Point2D.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class CDomain;
+class CDLOSolver;
+
+struct sLevelStats
+{
+	double Size;
+	size_t Nodes;
+	size_t Edges;
+	size_t Seeded;
+	size_t InitialAdmitted;
+	int Iterations;
+	double Lambda;
+	double Time;
+};
+
+// Solves a domain on successively finer meshes, halving the node spacing
+// every level.  A finer level starts with the edges that lie along the
+// yield lines of the coarser one already in the LP, and prices one round
+// against the coarse nodal forces interpolated to its nodes before its
+// first LP, so the column generation does not find the mechanism again.
+// Compact and streamed candidates are seeded too, and the number of seeded
+// edges and of edges the initial round admitted is reported per level.
+class CMultilevelDLO
+{
+public:
+	CMultilevelDLO( CDLOSolver* Solver ):
+		mSolver( Solver ),
+		mLevels( 2 )
+	{
+	};
+	virtual ~CMultilevelDLO() {};
+
+	// Discretizes and builds the edges of Domain at Size, Size / 2, ...,
+	// loads and yield moments are set beforehand.  Returns the load factor
+	// of the finest level.
+	double Solve( CDomain* Domain,
+				  double Size );
+
+	void SetLevels( int Levels ) { mLevels = Levels; };
+	int GetLevels() { return mLevels; };
+	const std::vector<sLevelStats>& GetLevelStats() { return mStats; };
+
+protected:
+	struct sYieldLine
+	{
+		CPoint2D P1, P2;
+	};
+
+	CDLOSolver* mSolver;
+	int mLevels;
+	std::vector<sLevelStats> mStats;
+
+	// The coarser level
+	std::vector<sYieldLine> mLines;
+	std::vector<CPoint2D> mPoints;
+	std::vector<std::array<size_t, 3>> mTriangles;
+	std::vector<double> mForces;
+
+	void fKeepLevel( CDomain* Domain );
+	size_t fSeedEdges( CDomain* Domain,
+					   double Size );
+	void fInterpolateForces( CDomain* Domain,
+							 std::vector<double>& Forces );
+};
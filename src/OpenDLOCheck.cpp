@@ -0,0 +1,803 @@
+// OpenDLOCheck.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+// Headless checks for ctest.  Every check solves the fixed unit square with
+// a unit live UDL and compares the load factor with a reference solve, by
+// default the kinematic barrier solve of the same mesh.
+
+#include "Constants.h"
+#include "Domain.h"
+#include "Enums.h"
+#include "LoadTable.h"
+#include "AutoDLOSolver.h"
+#include "CoinDLOSolver.h"
+#include "ConvergenceSweep.h"
+#include "MultilevelDLO.h"
+#ifdef DLO_WITH_HIGHS
+#include "HighsDLOSolver.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef std::function<void( CDomain& Domain )> tSetup;
+
+static const double kSize = 0.5;
+static const double kTolerance = 1e-4;
+static const char* kPoolFile = "OpenDLOCheck.pool";
+static const char* kSelectorFile = "OpenDLOCheck.selector";
+
+// Analytical load factor of the fixed square
+static const double kExact = 42.851;
+
+static void
+fPlate( CDomain& Domain )
+{
+	Domain.AddBoundaryPoint( { 0.0, 0.0 }, eEdgeType::FIXED );
+	Domain.AddBoundaryPoint( { 1.0, 0.0 }, eEdgeType::FIXED );
+	Domain.AddBoundaryPoint( { 1.0, 1.0 }, eEdgeType::FIXED );
+	Domain.AddBoundaryPoint( { 0.0, 1.0 }, eEdgeType::FIXED );
+
+	Domain.SetLoads( 1, 0 );
+	Domain.SetYieldMoments( 1, 1, 1, 1 );
+}
+
+static void
+fSquare( CDomain& Domain,
+		 const tSetup& Setup )
+{
+	fPlate( Domain );
+
+	if ( Setup )
+		Setup( Domain );
+
+	Domain.Discretize( kSize );
+	Domain.BuildEdges();
+}
+
+static double
+fSolve( CDLOSolver& Solver,
+		const tSetup& Setup = nullptr )
+{
+	CDomain Domain;
+	fSquare( Domain, Setup );
+
+	return Solver.Solve( &Domain );
+}
+
+static double
+fReference( const tSetup& Setup = nullptr )
+{
+	CCoinDLOSolver Solver;
+	return fSolve( Solver, Setup );
+}
+
+// Live load on the left half of the plate on top of the plate UDL
+static void
+fHalfLoad( CDomain& Domain )
+{
+	Domain.AddAreaLoad( { { 0.0, 0.0 }, { 0.5, 0.0 }, { 0.5, 1.0 }, { 0.0, 1.0 } }, 1, 0 );
+}
+
+static bool
+fCompareValue( const char* Name,
+			   double Value,
+			   double Expected )
+{
+	bool Result = std::abs( Value - Expected ) <= 1e-9;
+
+	std::cout << Name << ": " << Value << " expected " << Expected << (Result ? "" : " FAILED") << std::endl;
+
+	return Result;
+}
+
+static bool
+fCompare( const char* Name,
+		  double Lambda,
+		  double Reference )
+{
+	bool Result = Lambda > 0 && std::abs( Lambda - Reference ) <= kTolerance * Reference;
+
+	std::cout << Name << ": " << Lambda << " reference " << Reference << (Result ? "" : " FAILED") << std::endl;
+
+	return Result;
+}
+
+// solver <barrier|dual|primal|concurrent> <kinematic|equilibrium>
+static bool
+fCheckSolver( int argc,
+			  char** argv )
+{
+	CCoinDLOSolver Solver;
+
+	if ( argc > 2 )
+	{
+		const char* Names[] = { "barrier", "dual", "primal", "concurrent" };
+		for ( int i = 0; i < 4; ++i )
+		{
+			if ( strcmp( argv[2], Names[i] ) == 0 )
+				Solver.SetAlgorithm( (eLPAlgorithm)i );
+		}
+	}
+
+	if ( argc > 3 && strcmp( argv[3], "equilibrium" ) == 0 )
+		Solver.SetFormulation( eDLOFormulation::EQUILIBRIUM );
+
+	return fCompare( "Lambda", fSolve( Solver ), fReference() );
+}
+
+// cholesky <native|dense|ufl|pardiso>, GetCholesky must report the
+// requested factorisation when it was compiled in and the native one
+// otherwise, the barrier must reach the reference with it
+static bool
+fCheckCholesky( int argc,
+				char** argv )
+{
+	eCholeskyType Type = eCholeskyType::NATIVE;
+
+	if ( argc > 2 )
+	{
+		const char* Names[] = { "native", "dense", "ufl", "pardiso" };
+		for ( int i = 0; i < 4; ++i )
+		{
+			if ( strcmp( argv[2], Names[i] ) == 0 )
+				Type = (eCholeskyType)i;
+		}
+	}
+
+	CCoinDLOSolver Solver;
+	Solver.SetCholesky( Type );
+
+	eCholeskyType Expected = CCoinDLOSolver::IsCholeskyAvailable( Type ) ? Type : eCholeskyType::NATIVE;
+
+	std::cout << "Cholesky: " << (int)Solver.GetCholesky() << " expected " << (int)Expected << std::endl;
+
+	bool Result = fCompare( "Lambda", fSolve( Solver ), fReference() );
+	return Result && Solver.GetCholesky() == Expected;
+}
+
+// smoothing <memory|compact|streamed>, the smoothed duals must reach the
+// unsmoothed load factor and every mispriced round must be counted
+static bool
+fCheckSmoothing( int argc,
+				 char** argv )
+{
+	std::string Mode = argc > 2 ? argv[2] : "memory";
+
+	CCoinDLOSolver Solver;
+	Solver.SetDualSmoothing( 0.5 );
+
+	double Lambda = fSolve( Solver, [&Mode]( CDomain& Domain )
+	{
+		if ( Mode == "compact" )
+			Domain.SetCompactCandidates( true );
+		else if ( Mode == "streamed" )
+			Domain.SetCandidateBudget( CCandidatePool::GetMinimumBudget(), kPoolFile );
+	} );
+
+	int Mispriced = 0;
+	for ( const auto& Stats : Solver.GetIterationStats() )
+		Mispriced += Stats.Mispriced ? 1 : 0;
+
+	std::cout << "Misprices: " << Solver.GetMisprices() << " in " << Solver.GetIterationStats().size() << " iterations" << std::endl;
+
+	bool Result = fCompare( "Lambda", Lambda, fReference() );
+	return Result && Solver.GetMisprices() == Mispriced;
+}
+
+// partial <memory|compact|streamed>, partial pricing must reach the load
+// factor of the full sweep
+static bool
+fCheckPartial( int argc,
+			   char** argv )
+{
+	std::string Mode = argc > 2 ? argv[2] : "memory";
+
+	CCoinDLOSolver Solver;
+	Solver.SetPartialPricing( true );
+
+	double Lambda = fSolve( Solver, [&Mode]( CDomain& Domain )
+	{
+		if ( Mode == "compact" )
+			Domain.SetCompactCandidates( true );
+		else if ( Mode == "streamed" )
+			Domain.SetCandidateBudget( CCandidatePool::GetMinimumBudget(), kPoolFile );
+	} );
+
+	std::cout << "Iterations: " << Solver.GetIterationStats().size() << std::endl;
+
+	return fCompare( "Lambda", Lambda, fReference() );
+}
+
+// pipelined, pricing on two workers overlapped with the LP must reach the
+// load factor of the in line pricing
+static bool
+fCheckPipelined()
+{
+	CCoinDLOSolver Solver;
+	Solver.SetPipelinedPricing( 2 );
+
+	double Lambda = fSolve( Solver );
+
+	std::cout << "Iterations: " << Solver.GetIterationStats().size() << std::endl;
+
+	return fCompare( "Lambda", Lambda, fReference() );
+}
+
+// tolerance, the schedule must start loose, solve the last LP to
+// LP_TOLERANCE and reach the load factor of the tight solve
+static bool
+fCheckTolerance()
+{
+	CCoinDLOSolver Solver;
+	Solver.SetToleranceSchedule( 1e-3 );
+
+	double Lambda = fSolve( Solver );
+
+	const std::vector<sIterationStats>& Stats = Solver.GetIterationStats();
+
+	std::cout << "First tolerance: " << Stats.front().Tolerance << std::endl;
+
+	bool Result = fCompareValue( "Final tolerance", Stats.back().Tolerance, LP_TOLERANCE );
+	Result = fCompare( "Lambda", Lambda, fReference() ) && Result;
+
+	return Result && Stats.back().Tolerance == LP_TOLERANCE && Stats.front().Tolerance > LP_TOLERANCE;
+}
+
+// aging, aggressive column aging must drop edges, still reach the load
+// factor without aging and drop no edge more than kMaxDrops times
+static bool
+fCheckAging()
+{
+	CDomain Domain;
+	fSquare( Domain, nullptr );
+
+	CCoinDLOSolver Solver;
+	Solver.SetColumnAging( 1 );
+
+	double Lambda = Solver.Solve( &Domain );
+
+	size_t Dropped = 0;
+	for ( const auto& Stats : Solver.GetIterationStats() )
+		Dropped += Stats.Dropped;
+
+	int Drops = 0;
+	for ( auto Edge : Domain.GetEdges() )
+		Drops = std::max( Drops, Edge->Drops );
+
+	std::cout << "Dropped: " << Dropped << " in " << Solver.GetIterationStats().size() << " iterations" << std::endl;
+	std::cout << "Most drops of an edge: " << Drops << std::endl;
+
+	bool Result = fCompare( "Lambda", Lambda, fReference() );
+	return Result && Dropped > 0 && Drops <= CDLOSolver::kMaxDrops;
+}
+
+// candidates <compact|streamed> [load], streamed at the smallest budget so
+// the pool is built in several blocks.  The load factors of the half plate
+// load are kept with the candidates.
+static bool
+fCheckCandidates( int argc,
+				  char** argv )
+{
+	bool Streamed = argc > 2 && strcmp( argv[2], "streamed" ) == 0;
+	bool Load = argc > 3 && strcmp( argv[3], "load" ) == 0;
+
+	CCoinDLOSolver Solver;
+	double Lambda = fSolve( Solver, [Streamed, Load]( CDomain& Domain )
+	{
+		if ( Load )
+			fHalfLoad( Domain );
+
+		if ( Streamed )
+			Domain.SetCandidateBudget( CCandidatePool::GetMinimumBudget(), kPoolFile );
+		else
+			Domain.SetCompactCandidates( true );
+	} );
+
+	return fCompare( "Lambda", Lambda, fReference( Load ? fHalfLoad : tSetup() ) );
+}
+
+// budget <small|unwritable>, BuildEdges and Solve must both throw
+static bool
+fCheckBudget( int argc,
+			  char** argv )
+{
+	bool Small = argc > 2 && strcmp( argv[2], "small" ) == 0;
+
+	CDomain Domain;
+	bool Built = true;
+
+	try
+	{
+		fSquare( Domain, [Small]( CDomain& Domain )
+		{
+			if ( Small )
+				Domain.SetCandidateBudget( 1024, kPoolFile );
+			else
+				Domain.SetCandidateBudget( CCandidatePool::GetMinimumBudget(), std::string( "missing/" ) + kPoolFile );
+		} );
+	}
+	catch ( const std::runtime_error& Error )
+	{
+		std::cout << "BuildEdges: " << Error.what() << std::endl;
+		Built = false;
+	}
+
+	CCoinDLOSolver Solver;
+	bool Solved = true;
+
+	try
+	{
+		Solver.Solve( &Domain );
+	}
+	catch ( const std::runtime_error& Error )
+	{
+		std::cout << "Solve: " << Error.what() << std::endl;
+		Solved = false;
+	}
+
+	return !Built && !Solved;
+}
+
+// loads <area|point|opening|late>
+static bool
+fCheckLoads( int argc,
+			 char** argv )
+{
+	std::string Load = argc > 2 ? argv[2] : "";
+
+	// An area load over the whole plate is the plate UDL
+	if ( Load == "area" )
+	{
+		CCoinDLOSolver Solver;
+		double Lambda = fSolve( Solver, []( CDomain& Domain )
+		{
+			Domain.SetLoads( 0, 0 );
+			Domain.AddAreaLoad( { { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 }, { 0.0, 1.0 } }, 1, 0 );
+		} );
+
+		return fCompare( "Lambda", Lambda, fReference() );
+	}
+
+	// Loads added after BuildEdges would not be in the rows
+	if ( Load == "late" )
+	{
+		CDomain Domain;
+		fSquare( Domain, nullptr );
+
+		try
+		{
+			Domain.AddPointLoad( { 0.5, 0.5 }, 1, 0 );
+		}
+		catch ( const std::runtime_error& Error )
+		{
+			std::cout << "AddPointLoad: " << Error.what() << std::endl;
+			return true;
+		}
+
+		return false;
+	}
+
+	// The factors of a free edge along the bottom of the unit square, the
+	// whole square is above it
+	std::vector<CNode> Nodes = { { { 0.0, 0.0 }, 1 }, { { 1.0, 0.0 }, 2 } };
+	CEdge Edge( &Nodes, 1, 2, eEdgeType::FREE, 1, 1, 1, 1, 1 );
+
+	CPoly2D Outline;
+	Outline.SetPoints( { { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 }, { 0.0, 1.0 } } );
+
+	CLoadTable Table;
+	double Live[3] = { 0, 0, 0 };
+	double Dead[3] = { 0, 0, 0 };
+
+	// A point load on the edge counts half, one inside the piece in full
+	if ( Load == "point" )
+	{
+		size_t On = Table.Add( eLoadType::POINT, { { 0.5, 0.0 } }, 1, 0 );
+		size_t In = Table.Add( eLoadType::POINT, { { 0.5, 0.5 } }, 0, 0 );
+
+		Table.Calculate( { &Edge }, Outline );
+		Table.Combine( 0, Live, Dead );
+
+		bool Result = fCompareValue( "On the edge", Live[2], 0.5 );
+
+		Table.SetMagnitude( On, 0, 0 );
+		Table.SetMagnitude( In, 1, 0 );
+
+		std::fill( Live, Live + 3, 0.0 );
+		Table.Combine( 0, Live, Dead );
+
+		Result = fCompareValue( "Inside", Live[2], 1.0 ) && Result;
+		return fCompareValue( "Inside moment", Live[0], 0.5 ) && Result;
+	}
+
+	// The opening takes its share of the plate UDL off again: area 0.25 at
+	// a lever of 0.5
+	if ( Load == "opening" )
+	{
+		CPoly2D Opening;
+		Opening.SetPoints( { { 0.25, 0.25 }, { 0.75, 0.25 }, { 0.75, 0.75 }, { 0.25, 0.75 } } );
+
+		Table.SetPlateLoad( 1, 0 );
+		Table.SetOpenings( { Opening } );
+		Table.Calculate( { &Edge }, Outline );
+		Table.Combine( 0, Live, Dead );
+
+		bool Result = fCompareValue( "Opening", Live[2], -0.25 );
+		return fCompareValue( "Opening moment", Live[0], -0.125 ) && Result;
+	}
+
+	return false;
+}
+
+// ordering <hilbert|rcm>, the renumbered mesh must hold the nodes of the
+// unordered one under the IDs 1..n, in another order, and give its load
+// factor
+static bool
+fCheckOrdering( int argc,
+				char** argv )
+{
+	eNodeOrdering Ordering = argc > 2 && strcmp( argv[2], "rcm" ) == 0 ?
+		eNodeOrdering::REVERSE_CUTHILL_MCKEE : eNodeOrdering::HILBERT;
+
+	tSetup Setup = [Ordering]( CDomain& Domain )
+	{
+		Domain.SetNodeOrdering( Ordering );
+	};
+
+	CDomain Ordered, Unordered;
+	fSquare( Ordered, Setup );
+	fSquare( Unordered, nullptr );
+
+	const std::vector<CNode>& Nodes = Ordered.GetNodes();
+
+	std::vector<size_t> IDs;
+	std::vector<std::pair<double, double>> Points, Expected;
+	size_t Moved = 0;
+
+	for ( size_t i = 0; i < Nodes.size(); ++i )
+	{
+		const CPoint2D& Point = Unordered.GetNodes()[i].Point;
+
+		IDs.push_back( Nodes[i].ID );
+		Points.push_back( { Nodes[i].Point.x, Nodes[i].Point.y } );
+		Expected.push_back( { Point.x, Point.y } );
+
+		if ( Nodes[i].Point.x != Point.x || Nodes[i].Point.y != Point.y )
+			++Moved;
+	}
+
+	std::sort( IDs.begin(), IDs.end() );
+	std::sort( Points.begin(), Points.end() );
+	std::sort( Expected.begin(), Expected.end() );
+
+	bool Permutation = Nodes.size() == Unordered.GetNodes().size() && Points == Expected;
+	for ( size_t i = 0; i < IDs.size(); ++i )
+		Permutation = Permutation && IDs[i] == i + 1;
+
+	std::cout << "Nodes: " << Nodes.size() << ", moved " << Moved << std::endl;
+	std::cout << "Permutation: " << (Permutation ? "yes" : "no FAILED") << std::endl;
+
+	CCoinDLOSolver Solver;
+	bool Result = fCompare( "Lambda", Solver.Solve( &Ordered ), fReference() );
+
+	return Result && Permutation && Moved > 0;
+}
+
+// bounds, the pricing bounds must skip some of the candidates of the mesh
+static bool
+fCheckBounds()
+{
+	CCoinDLOSolver Solver;
+	double Lambda = fSolve( Solver );
+
+	size_t Priced = 0, Skipped = 0;
+	for ( const auto& Stats : Solver.GetIterationStats() )
+	{
+		Priced += Stats.Priced;
+		Skipped += Stats.Skipped;
+	}
+
+	std::cout << "Skipped by bounds: " << Skipped << " of " << Priced + Skipped << std::endl;
+
+	return Lambda > 0 && Skipped > 0;
+}
+
+// multilevel <memory|compact|streamed|pipelined>, the finer level must
+// seed edges and admit some in the round against the coarse forces
+static bool
+fCheckMultilevel( int argc,
+				  char** argv )
+{
+	std::string Mode = argc > 2 ? argv[2] : "memory";
+
+	CDomain Domain;
+	fSquare( Domain, [&Mode]( CDomain& Domain )
+	{
+		if ( Mode == "compact" )
+			Domain.SetCompactCandidates( true );
+		else if ( Mode == "streamed" )
+			Domain.SetCandidateBudget( CCandidatePool::GetMinimumBudget(), kPoolFile );
+	} );
+
+	CCoinDLOSolver Solver;
+	if ( Mode == "pipelined" )
+		Solver.SetPipelinedPricing( 2 );
+
+	CMultilevelDLO Multilevel( &Solver );
+	double Lambda = Multilevel.Solve( &Domain, kSize );
+
+	const sLevelStats& Stats = Multilevel.GetLevelStats().back();
+
+	std::cout << "Lambda: " << Lambda << std::endl;
+	std::cout << "Seeded: " << Stats.Seeded << std::endl;
+	std::cout << "Initial admitted: " << Stats.InitialAdmitted << std::endl;
+
+	return Lambda > 0 && Stats.Seeded > 0 && Stats.InitialAdmitted > 0;
+}
+
+// Load factors of a sweep made up from Lambda = Limit + b * h^Order
+class CSyntheticSweep : public CConvergenceSweep
+{
+public:
+	CSyntheticSweep():
+		CConvergenceSweep( nullptr, nullptr )
+	{
+	};
+
+	void Extrapolate( double Limit,
+					  double Slope,
+					  double Order )
+	{
+		mLevels.clear();
+
+		for ( double Size = 0.0625; Size <= 0.5; Size *= 2 )
+			mLevels.push_back( { Size, 0, 0, Limit + Slope * std::pow( Size, Order ), 0, "" } );
+
+		fExtrapolate();
+	}
+};
+
+// sweep <fit|square|streamed|error>, fit extrapolates made up load factors,
+// the others sweep the square at two sizes at once
+static bool
+fCheckSweep( int argc,
+			 char** argv )
+{
+	std::string Mode = argc > 2 ? argv[2] : "fit";
+
+	if ( Mode == "fit" )
+	{
+		CSyntheticSweep Sweep;
+		Sweep.Extrapolate( kExact, 5.0, 1.5 );
+
+		bool Result = fCompareValue( "Order", std::round( Sweep.GetOrder() * 1e4 ) / 1e4, 1.5 );
+		return fCompare( "Limit", Sweep.GetLimit(), kExact ) && Result;
+	}
+
+	auto Factory = []() -> std::unique_ptr<CDLOSolver>
+	{
+		return std::unique_ptr<CDLOSolver>( new CCoinDLOSolver() );
+	};
+
+	// Two levels at once, streamed levels each get their own pool file
+	CConvergenceSweep Sweep( [&Mode]( CDomain& Domain )
+	{
+		fPlate( Domain );
+
+		if ( Mode == "streamed" )
+			Domain.SetCandidateBudget( CCandidatePool::GetMinimumBudget(), kPoolFile );
+		else if ( Mode == "error" )
+			Domain.SetCandidateBudget( 1024, kPoolFile );
+	}, Factory );
+
+	Sweep.SetThreads( 2 );
+
+	if ( Mode == "error" )
+	{
+		try
+		{
+			Sweep.Solve( { kSize, kSize / 2 } );
+		}
+		catch ( const std::runtime_error& Error )
+		{
+			std::cout << "Solve: " << Error.what() << std::endl;
+
+			size_t Failed = 0;
+			for ( const auto& Level : Sweep.GetLevels() )
+				Failed += Level.Error.empty() ? 0 : 1;
+
+			return Failed == Sweep.GetLevels().size();
+		}
+
+		return false;
+	}
+
+	double Limit = Sweep.Solve( { kSize, kSize / 2 } );
+	double Finest = Sweep.GetLevels().front().Lambda;
+
+	std::cout << "Finest: " << Finest << std::endl;
+	std::cout << "Limit: " << Limit << " exact " << kExact << std::endl;
+
+	return std::abs( Limit - kExact ) < std::abs( Finest - kExact );
+}
+
+// auto <solve|selector>, solve compares the auto solver with the barrier,
+// selector calibrates a selector from made up timings and the saved file
+// must make the same choices once loaded
+static bool
+fCheckAuto( int argc,
+			char** argv )
+{
+	std::string Mode = argc > 2 ? argv[2] : "solve";
+
+	if ( Mode == "solve" )
+	{
+		CAutoDLOSolver Solver;
+		double Lambda = fSolve( Solver );
+
+		std::cout << "Samples: " << Solver.GetSamples().size() << std::endl;
+
+		return fCompare( "Lambda", Lambda, fReference() );
+	}
+
+	// Time = Fixed + Scale * Size^Exponent with the default Fixed of each
+	// entry, the dual simplex wins the small LPs and the barrier the large
+	struct sLaw
+	{
+		sLPChoice Choice;
+		double Fixed;
+		double Scale;
+		double Exponent;
+	};
+
+	const sLaw Laws[] =
+	{
+		{ { eLPBackend::CLP, eLPAlgorithm::BARRIER, false }, 2e-3, 1e-6, 1.1 },
+		{ { eLPBackend::CLP, eLPAlgorithm::DUAL_SIMPLEX, false }, 1e-3, 2e-8, 1.7 },
+		{ { eLPBackend::HIGHS, eLPAlgorithm::DUAL_SIMPLEX, true }, 5e-4, 3e-7, 1.3 }
+	};
+
+	std::vector<sLPSample> Samples;
+	for ( const auto& Law : Laws )
+	{
+		for ( double Size = 1e2; Size <= 1e6; Size *= 10 )
+			Samples.push_back( { Law.Choice, Size, Law.Fixed + Law.Scale * std::pow( Size, Law.Exponent ) } );
+	}
+
+	CLPSelector Calibrated;
+	Calibrated.SetAvailable( eLPBackend::HIGHS, true );
+	Calibrated.Calibrate( Samples );
+	Calibrated.Save( kSelectorFile );
+
+	CLPSelector Loaded;
+	Loaded.SetAvailable( eLPBackend::HIGHS, true );
+
+	if ( !Loaded.Load( kSelectorFile ) )
+	{
+		std::cout << "Load: " << kSelectorFile << " FAILED" << std::endl;
+		return false;
+	}
+
+	if ( Loaded.GetCosts().size() != Calibrated.GetCosts().size() )
+		return false;
+
+	bool Result = fCompareValue( "Dual exponent", std::round( Calibrated.GetCosts()[1].Exponent * 1e4 ) / 1e4, 1.7 );
+
+	size_t Choices = 0, Differences = 0, Duals = 0;
+
+	for ( double Nonzeros = 10; Nonzeros <= 1e8; Nonzeros *= 10 )
+	{
+		for ( int Warm = 0; Warm < 2; ++Warm )
+		{
+			sLPFeatures Features = { 2, 0, 0, static_cast<size_t>(Nonzeros), static_cast<size_t>(Nonzeros / 10), Warm != 0, eLPBackend::HIGHS };
+
+			sLPChoice First = Calibrated.Select( Features );
+			sLPChoice Second = Loaded.Select( Features );
+
+			if ( First.Backend != Second.Backend ||
+				 First.Algorithm != Second.Algorithm ||
+				 First.Warm != Second.Warm )
+				++Differences;
+
+			// The saved model itself, not only the choice it makes here
+			for ( size_t i = 0; i < Calibrated.GetCosts().size(); ++i )
+			{
+				if ( Calibrated.Estimate( Calibrated.GetCosts()[i], Features ) !=
+					 Loaded.Estimate( Loaded.GetCosts()[i], Features ) )
+					++Differences;
+			}
+
+			if ( First.Algorithm == eLPAlgorithm::DUAL_SIMPLEX )
+				++Duals;
+
+			++Choices;
+		}
+	}
+
+	std::cout << "Dual simplex choices: " << Duals << " of " << Choices << std::endl;
+	std::cout << "Differences after Load: " << Differences << std::endl;
+
+	return Result && Differences == 0 && Duals > 0 && Duals < Choices;
+}
+
+#ifdef DLO_WITH_HIGHS
+// highs <barrier|dual|primal>
+static bool
+fCheckHighs( int argc,
+			 char** argv )
+{
+	CHighsDLOSolver Solver;
+
+	if ( argc > 2 )
+	{
+		const char* Names[] = { "barrier", "dual", "primal" };
+		for ( int i = 0; i < 3; ++i )
+		{
+			if ( strcmp( argv[2], Names[i] ) == 0 )
+				Solver.SetAlgorithm( (eLPAlgorithm)i );
+		}
+	}
+
+	return fCompare( "Lambda", fSolve( Solver ), fReference() );
+}
+#endif
+
+int main( int argc, char** argv )
+{
+	if ( argc < 2 )
+	{
+		std::cerr << "Usage: OpenDLOCheck <check> [options]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::string Check = argv[1];
+	bool Result = false;
+
+	if ( Check == "solver" )
+		Result = fCheckSolver( argc, argv );
+	else if ( Check == "cholesky" )
+		Result = fCheckCholesky( argc, argv );
+	else if ( Check == "smoothing" )
+		Result = fCheckSmoothing( argc, argv );
+	else if ( Check == "partial" )
+		Result = fCheckPartial( argc, argv );
+	else if ( Check == "pipelined" )
+		Result = fCheckPipelined();
+	else if ( Check == "tolerance" )
+		Result = fCheckTolerance();
+	else if ( Check == "aging" )
+		Result = fCheckAging();
+	else if ( Check == "candidates" )
+		Result = fCheckCandidates( argc, argv );
+	else if ( Check == "budget" )
+		Result = fCheckBudget( argc, argv );
+	else if ( Check == "loads" )
+		Result = fCheckLoads( argc, argv );
+	else if ( Check == "ordering" )
+		Result = fCheckOrdering( argc, argv );
+	else if ( Check == "bounds" )
+		Result = fCheckBounds();
+	else if ( Check == "sweep" )
+		Result = fCheckSweep( argc, argv );
+	else if ( Check == "multilevel" )
+		Result = fCheckMultilevel( argc, argv );
+	else if ( Check == "auto" )
+		Result = fCheckAuto( argc, argv );
+#ifdef DLO_WITH_HIGHS
+	else if ( Check == "highs" )
+		Result = fCheckHighs( argc, argv );
+#endif
+	else
+		std::cerr << "Unknown check " << Check << std::endl;
+
+	return Result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
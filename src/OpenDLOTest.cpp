@@ -2,19 +2,124 @@
 // Copyright (c) 2022, Renier Cloete
 // This program is released under the BSD license. See the file LICENSE.txt for details.
 
+#include "Constants.h"
 #include "Domain.h"
 #include "Enums.h"
+#ifdef DLO_WITH_MOSEK
 #include "MosekDLOSolver.h"
+#endif
 #include "CoinDLOSolver.h"
 
+#ifndef DLO_HEADLESS
 #include <glad/gl.h>
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 
 #include "linmath.h"
+#endif
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <iostream>
+
+#ifdef DLO_HEADLESS
+#include <atomic>
+#include <new>
+
+// Counts every heap allocation of the process
+static std::atomic<size_t> gAllocations( 0 );
+
+void* operator new( size_t Size )
+{
+	++gAllocations;
+
+	if ( void* Memory = malloc( Size ? Size : 1 ) )
+		return Memory;
+
+	throw std::bad_alloc();
+}
+
+void operator delete( void* Memory ) noexcept
+{
+	free( Memory );
+}
+
+void operator delete( void* Memory, size_t ) noexcept
+{
+	free( Memory );
+}
+
+// Counts the allocations of the iterations after the second LP: pricing,
+// admission, the bookkeeping of the column generation and the assembly of
+// the LP.  The first rounds size the buffers and cache the UDL factors of
+// every edge, the count starts after them.  The allocations inside Clp are
+// counted apart: loadProblem, addRows, addColumns, deleteRows and
+// deleteColumns copy the model into Clp's own arrays, and every solve
+// allocates its factorisation, the barrier also a new Cholesky object.
+class CAllocationCounter : public CCoinDLOSolver
+{
+public:
+	double Solve( CDomain* Domain ) override
+	{
+		mLPs = 0;
+		mMark = 0;
+		mAllocations = 0;
+		mClpAllocations = 0;
+
+		double Result = CCoinDLOSolver::Solve( Domain );
+
+		if ( mLPs > 2 )
+			mAllocations = gAllocations - mMark - mClpAllocations;
+
+		return Result;
+	};
+
+	size_t GetAllocations() { return mAllocations; };
+	size_t GetClpAllocations() { return mClpAllocations; };
+
+protected:
+	size_t mLPs = 0;
+	size_t mMark = 0;
+	size_t mAllocations = 0;
+	size_t mClpAllocations = 0;
+
+	double* fSolve( double& Objective ) override
+	{
+		double* Result = CCoinDLOSolver::fSolve( Objective );
+
+		if ( ++mLPs == 2 )
+			mMark = gAllocations;
+
+		return Result;
+	};
+
+	void fRunAlgorithm( int Columns,
+						int Rows ) override
+	{
+		size_t Before = gAllocations;
+
+		CCoinDLOSolver::fRunAlgorithm( Columns, Rows );
+
+		fCountClp( Before );
+	};
+
+	void fRunEquilibrium() override
+	{
+		size_t Before = gAllocations;
+
+		CCoinDLOSolver::fRunEquilibrium();
+
+		fCountClp( Before );
+	};
+
+	void fCountClp( size_t Before )
+	{
+		if ( mLPs >= 2 )
+			mClpAllocations += gAllocations - Before;
+	};
+};
+#else
 
 static const char* vertex_shader_text =
 "#version 110\n"
@@ -46,8 +151,9 @@ static void key_callback( GLFWwindow* window, int key, int scancode, int action,
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose( window, GLFW_TRUE );
 }
+#endif
 
-int main()
+int main( int argc, char** argv )
 {
 	//Calculate yield lines & load factor
 
@@ -68,7 +174,41 @@ int main()
 	
 	DomainEdges = Domain.GetBoundaryPoints();
 
+#ifdef DLO_HEADLESS
+	CAllocationCounter Solver;
+#else
 	CCoinDLOSolver Solver;
+#endif
+
+	//Optional Cholesky backend for the Clp barrier: native, dense, ufl or pardiso
+
+	if (argc > 1)
+	{
+		const char* Names[] = { "native", "dense", "ufl", "pardiso" };
+		for (int i = 0; i < 4; ++i)
+		{
+			if (strcmp( argv[1], Names[i] ) == 0)
+				Solver.SetCholesky( (eCholeskyType)i );
+		}
+	}
+
+	//Optional LP algorithm: barrier, dual, primal or concurrent
+
+	if (argc > 2)
+	{
+		const char* Names[] = { "barrier", "dual", "primal", "concurrent" };
+		for (int i = 0; i < 4; ++i)
+		{
+			if (strcmp( argv[2], Names[i] ) == 0)
+				Solver.SetAlgorithm( (eLPAlgorithm)i );
+		}
+	}
+
+	//Optional formulation: kinematic or equilibrium
+
+	if (argc > 3 && strcmp( argv[3], "equilibrium" ) == 0)
+		Solver.SetFormulation( eDLOFormulation::EQUILIBRIUM );
+
 	double Lambda = Solver.Solve( &Domain );
 
 	//Output
@@ -77,6 +217,37 @@ int main()
 
 	YieldEdges = Solver.GetEdgeData();
 
+#ifdef DLO_HEADLESS
+	std::cout << std::endl;
+	std::cout << "Cholesky: " << (int)Solver.GetCholesky() << std::endl;
+
+	for (const auto& Stats : Solver.GetIterationStats())
+	{
+		std::cout <<
+			Stats.Iteration << " " <<
+			Stats.Columns << " " <<
+			Stats.Rows << " " <<
+			Stats.Objective << " " <<
+			Stats.LPTime << " " <<
+			Stats.PricingTime << " " <<
+			(int)Stats.Algorithm << std::endl;
+	}
+
+	size_t Priced = 0, Skipped = 0;
+	for (const auto& Stats : Solver.GetIterationStats())
+	{
+		Priced += Stats.Priced;
+		Skipped += Stats.Skipped;
+	}
+
+	std::cout << "Skipped by bounds: " << Skipped << " of " << Priced + Skipped << std::endl;
+	std::cout << "Yield lines: " << YieldEdges.size() / 8 << std::endl;
+	std::cout << "Allocations in the iterations: " << Solver.GetAllocations() << std::endl;
+	std::cout << "Allocations inside Clp: " << Solver.GetClpAllocations() << std::endl;
+
+	return Lambda > 0 && Solver.GetAllocations() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+
 	struct sVertex
 	{
 		float x, y;
@@ -228,5 +399,6 @@ int main()
 
 	glfwTerminate();
 	exit( EXIT_SUCCESS );
+#endif
 
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 class CPoint2D
 {
 public:
@@ -8,6 +8,10 @@
 #include <algorithm>
 #include "Constants.h"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 /*#include <gl/gl.h>
 #include <gl/glu.h>*/
 
@@ -101,7 +105,7 @@ void AddUnique( const CPoint2D& p,
 	auto iter =std::find_if( Vector.begin(), Vector.end(),
 					  [p]( const CPoint2D& l )
 	{
-		return (l - p).Length() < EPSILON;
+		return (l - p).LengthSquared() < EPSILON * EPSILON;
 	}
 	);
 
@@ -113,32 +117,25 @@ void
 CPoly2D::GetOrderedIntersections( const CLine2D& line,
 								  std::vector<CPoint2D>& Intersections ) const
 {
-	bool Result = true;
-	std::vector<CPoint2D> Points;
-
 	CLine2D pline;
-	for ( int i = 0; i < (int)mPoints.size() - 1; ++i )
+	for ( size_t i = 0; i < mPoints.size(); ++i )
 	{
-		pline.Set( mPoints[i], mPoints[i + 1], false );
-		Intersect( pline, line, Points );
+		pline.Set( mPoints[i], mPoints[(i + 1) % mPoints.size()], false );
+		sIntersection Hit = Intersect( pline, line );
 
-		for ( int j = 0; j<(int)Points.size(); ++j )
-			AddUnique( Points[j], Intersections );
+		if ( Hit.Type != eIntersectionType::NONE )
+			AddUnique( Hit.P1, Intersections );
+		if ( Hit.Type == eIntersectionType::OVERLAP )
+			AddUnique( Hit.P2, Intersections );
 	}
 
-	pline.Set( mPoints[mPoints.size() - 1], mPoints[0], false );
-	Intersect( pline, line, Points );
-
-	for ( int j = 0; j<(int)Points.size(); ++j )
-		AddUnique( Points[j], Intersections );
-
 	AddUnique( line.P1(), Intersections );
 	AddUnique( line.P2(), Intersections );
 
 	std::sort( Intersections.begin(), Intersections.end(),
 			   [line]( const CPoint2D& l, const CPoint2D& r )
 	{
-		return (line.P1() - l).Length() < (line.P1() - r).Length();
+		return (line.P1() - l).LengthSquared() < (line.P1() - r).LengthSquared();
 	}
 	);
 }
@@ -147,73 +144,86 @@ std::vector<CPoint2D>
 CPoly2D::IntersectWith( const CLine2D& line )
 {
 	std::vector<CPoint2D> result;
+	size_t n = mPoints.size();
+
+	if ( n == 0 )
+		return result;
+
+	// All edges against the line in one batch
+	std::vector<double> x( n + 1 ), y( n + 1 );
+	for ( size_t i = 0; i <= n; ++i )
+	{
+		x[i] = mPoints[i % n].x;
+		y[i] = mPoints[i % n].y;
+	}
+
+	std::vector<sIntersection> Hits( n );
+	Intersect( x.data(), y.data(), n, line, Hits.data() );
+
+	// Intersections at a corner mark it, others become marked corners
 	std::vector<CPoint2D> Points;
+	Points.reserve( n );
 
-	CLine2D pline;
-	for ( int i = 0; i<(int)mPoints.size() - 1; ++i )
+	auto Near = []( const CPoint2D& a, const CPoint2D& b )
 	{
-		pline.Set( mPoints[i], mPoints[i + 1], false );
-		Intersect( pline, line, Points );
+		return (a - b).LengthSquared() < EPSILON * EPSILON;
+	};
 
-		for ( int j = 0; j<(int)Points.size(); ++j )
+	for ( size_t i = 0; i < n; ++i )
+	{
+		const sIntersection& Hit = Hits[i];
+		if ( Hit.Type == eIntersectionType::NONE )
+			continue;
+
+		CPoint2D Ends[2] = { Hit.P1, Hit.P2 };
+		size_t Count = Hit.Type == eIntersectionType::OVERLAP ? 2 : 1;
+
+		for ( size_t j = 0; j < Count; ++j )
 		{
-			CPoint2D& p = Points[j];
-			if ( p.DistanceTo( mPoints[i] ) < EPSILON )
+			const CPoint2D& p = Ends[j];
+
+			if ( Near( p, mPoints[i] ) )
 				mPoints[i].mark = 1;
-			else if ( p.DistanceTo( mPoints[i + 1] ) < EPSILON )
-				mPoints[i + 1].mark = 1;
-			else
-			{
-				InsertPoint( i + 1, p );
-				mPoints[i + 1].mark = 1;
-			}
+			else if ( Near( p, mPoints[(i + 1) % n] ) )
+				mPoints[(i + 1) % n].mark = 1;
 
-			std::vector<CPoint2D>::iterator iter =
-				std::find_if( result.begin(), result.end(),
-							  [p]( const CPoint2D& l )
-			{
-				return (l - p).Length() < EPSILON;
-			}
-			);
-			if ( iter == result.end() )
-				result.push_back( p );
+			AddUnique( p, result );
 		}
 	}
 
-	if ( mPoints.size() )
+	for ( size_t i = 0; i < n; ++i )
 	{
-		pline.Set( mPoints[mPoints.size() - 1], mPoints[0], false );
-		Intersect( pline, line, Points );
+		Points.push_back( mPoints[i] );
+
+		const sIntersection& Hit = Hits[i];
+		if ( Hit.Type == eIntersectionType::NONE )
+			continue;
+
+		const CPoint2D& a = mPoints[i];
+		const CPoint2D& b = mPoints[(i + 1) % n];
 
-		for ( int j = 0; j < (int)Points.size(); ++j )
+		CPoint2D Ends[2] = { Hit.P1, Hit.P2 };
+		size_t Count = Hit.Type == eIntersectionType::OVERLAP ? 2 : 1;
+
+		if ( Count == 2 && (Ends[0] - a).LengthSquared() > (Ends[1] - a).LengthSquared() )
+			std::swap( Ends[0], Ends[1] );
+
+		for ( size_t j = 0; j < Count; ++j )
 		{
-			CPoint2D& p = Points[j];
-			if ( p.DistanceTo( mPoints[mPoints.size() - 1] ) < EPSILON )
-				mPoints[mPoints.size() - 1].mark = 1;
-			else if ( p.DistanceTo( mPoints[0] ) < EPSILON )
-				mPoints[0].mark = 1;
-			else
-			{
-				mPoints.push_back( p );
-				mPoints.back().mark = 1;
-			}
+			if ( Near( Ends[j], a ) || Near( Ends[j], b ) )
+				continue;
 
-			std::vector<CPoint2D>::iterator iter =
-				std::find_if( result.begin(), result.end(),
-							  [p]( const CPoint2D& l )
-			{
-				return (l - p).Length() < EPSILON;
-			}
-			);
-			if ( iter == result.end() )
-				result.push_back( p );
+			Points.push_back( Ends[j] );
+			Points.back().mark = 1;
 		}
 	}
 
+	mPoints.swap( Points );
+
 	std::sort( result.begin(), result.end(),
 			   [line]( const CPoint2D& l, const CPoint2D& r )
 	{
-		return (line.P1() - l).Length() < (line.P1() - r).Length();
+		return (line.P1() - l).LengthSquared() < (line.P1() - r).LengthSquared();
 	}
 	);
 
@@ -234,24 +244,26 @@ CPoly2D::Reverse()
 
 double
 CPoly2D::Area() const
+{
+	return Area( mPoints.data(), mPoints.size() );
+}
+
+double
+CPoly2D::Area( const CPoint2D* Points,
+			   size_t Count )
 {
 	CPoint2D p1, p2;
 
 	double a = 0;
 
-	for ( int i = 0; i<mPoints.size() - 1; i++ )
+	for ( size_t i = 0; i < Count; i++ )
 	{
-		p1 = mPoints[i];
-		p2 = mPoints[i + 1];
+		p1 = Points[i];
+		p2 = Points[(i + 1) % Count];
 
 		a = a + (p1[0] * p2[1] - p2[0] * p1[1]);
 	}
 
-	p1 = mPoints[mPoints.size() - 1];
-	p2 = mPoints[0];
-
-	a = a + (p1[0] * p2[1] - p2[0] * p1[1]);
-
 	a *= 0.5;
 
 	return a;
@@ -259,42 +271,28 @@ CPoly2D::Area() const
 
 CPoint2D
 CPoly2D::Centroid() const
+{
+	return Centroid( mPoints.data(), mPoints.size() );
+}
+
+CPoint2D
+CPoly2D::Centroid( const CPoint2D* Points,
+				   size_t Count )
 {
 	CPoint2D result( 0, 0 );
 	CPoint2D p1, p2;
 
-	double a = 0;
-
-	for ( int i = 0; i<mPoints.size() - 1; i++ )
-	{
-		p1 = mPoints[i];
-		p2 = mPoints[i + 1];
-
-		a = a + (p1[0] * p2[1] - p2[0] * p1[1]);
-	}
-
-	p1 = mPoints[mPoints.size() - 1];
-	p2 = mPoints[0];
-
-	a = a + (p1[0] * p2[1] - p2[0] * p1[1]);
+	double a = Area( Points, Count );
 
-	a *= 0.5;
-
-	for ( int i = 0; i<mPoints.size() - 1; i++ )
+	for ( size_t i = 0; i < Count; i++ )
 	{
-		p1 = mPoints[i];
-		p2 = mPoints[i + 1];
+		p1 = Points[i];
+		p2 = Points[(i + 1) % Count];
 
 		result[0] = result[0] + (p1[0] + p2[0])*(p1[0] * p2[1] - p2[0] * p1[1]);
 		result[1] = result[1] + (p1[1] + p2[1])*(p1[0] * p2[1] - p2[0] * p1[1]);
 	}
 
-	p1 = mPoints[mPoints.size() - 1];
-	p2 = mPoints[0];
-
-	result[0] = result[0] + (p1[0] + p2[0])*(p1[0] * p2[1] - p2[0] * p1[1]);
-	result[1] = result[1] + (p1[1] + p2[1])*(p1[0] * p2[1] - p2[0] * p1[1]);
-
 	result[0] = result[0] / (6 * a);
 	result[1] = result[1] / (6 * a);
 
@@ -596,18 +594,26 @@ CPoly2D::ClipRight( const CLine2D& Line ) const
 bool 
 CPoly2D::PointInPoly( const CPoint2D& p ) const
 {
-	int polyCorners = static_cast<int>(mPoints.size());
+	return PointInPoly( mPoints.data(), mPoints.size(), p );
+}
+
+bool 
+CPoly2D::PointInPoly( const CPoint2D* Points,
+					  size_t Count,
+					  const CPoint2D& p )
+{
+	int polyCorners = static_cast<int>(Count);
 
 	int   i, j = polyCorners - 1;
 	bool  oddNodes = false;
 
 	for ( i = 0; i<polyCorners; i++ )
 	{
-		if ( (mPoints[i].y< p.y && mPoints[j].y >= p.y
-			   || mPoints[j].y< p.y && mPoints[i].y >= p.y)
-			 && (mPoints[i].x <= p.x || mPoints[j].x <= p.x) )
+		if ( (Points[i].y< p.y && Points[j].y >= p.y
+			   || Points[j].y< p.y && Points[i].y >= p.y)
+			 && (Points[i].x <= p.x || Points[j].x <= p.x) )
 		{
-			oddNodes ^= (mPoints[i].x + (p.y - mPoints[i].y) / (mPoints[j].y - mPoints[i].y)*(mPoints[j].x - mPoints[i].x)<p.x);
+			oddNodes ^= (Points[i].x + (p.y - Points[i].y) / (Points[j].y - Points[i].y)*(Points[j].x - Points[i].x)<p.x);
 		}
 		j = i;
 	}
@@ -617,28 +623,216 @@ CPoly2D::PointInPoly( const CPoint2D& p ) const
 
 int
 CPoly2D::PointOnPoly( const CPoint2D& p ) const
+{
+	return PointOnPoly( mPoints.data(), mPoints.size(), p );
+}
+
+int
+CPoly2D::PointOnPoly( const CPoint2D* Points,
+					  size_t Count,
+					  const CPoint2D& p )
 {
 	CLine2D Line;
-	for ( size_t i = 1; i < mPoints.size(); ++i )
+	for ( size_t i = 1; i < Count; ++i )
 	{
 
-		Line.Set( mPoints[i - 1], mPoints[i] );
+		Line.Set( Points[i - 1], Points[i] );
 
 		if ( Line.DistanceTo( p ) < EPSILON )
 			return static_cast<int>(i)-1;
 	}
 
-	if ( mPoints.size() > 1 )
+	if ( Count > 1 )
 	{
-		Line.Set( mPoints[mPoints.size()-1], mPoints[0] );
+		Line.Set( Points[Count-1], Points[0] );
 
 		if ( Line.DistanceTo( p ) < EPSILON )
-			return static_cast<int>(mPoints.size())-1;
+			return static_cast<int>(Count)-1;
 	}
 
 	return -1;
 }
 
+void
+CPoly2D::PointsInPoly( const double* x,
+					   const double* y,
+					   size_t Count,
+					   uint64_t* Mask ) const
+{
+	std::fill( Mask, Mask + MaskWords( Count ), 0 );
+
+	size_t i = 0;
+
+	// Lane k holds point i + k, the edges are broadcast.  Same crossing rule
+	// as PointInPoly.
+#ifdef __AVX2__
+	size_t Corners = mPoints.size();
+
+	for ( ; i + 4 <= Count; i += 4 )
+	{
+		__m256d px = _mm256_loadu_pd( x + i );
+		__m256d py = _mm256_loadu_pd( y + i );
+		__m256d Odd = _mm256_setzero_pd();
+
+		for ( size_t c = 0, j = Corners - 1; c < Corners; j = c++ )
+		{
+			__m256d xi = _mm256_set1_pd( mPoints[c].x );
+			__m256d yi = _mm256_set1_pd( mPoints[c].y );
+			__m256d xj = _mm256_set1_pd( mPoints[j].x );
+			__m256d yj = _mm256_set1_pd( mPoints[j].y );
+
+			__m256d Straddle = _mm256_or_pd(
+				_mm256_and_pd( _mm256_cmp_pd( yi, py, _CMP_LT_OQ ), _mm256_cmp_pd( yj, py, _CMP_GE_OQ ) ),
+				_mm256_and_pd( _mm256_cmp_pd( yj, py, _CMP_LT_OQ ), _mm256_cmp_pd( yi, py, _CMP_GE_OQ ) ) );
+			__m256d Left = _mm256_or_pd( _mm256_cmp_pd( xi, px, _CMP_LE_OQ ), _mm256_cmp_pd( xj, px, _CMP_LE_OQ ) );
+
+			__m256d Cross = _mm256_add_pd( xi,
+				_mm256_mul_pd( _mm256_div_pd( _mm256_sub_pd( py, yi ), _mm256_sub_pd( yj, yi ) ), _mm256_sub_pd( xj, xi ) ) );
+
+			Odd = _mm256_xor_pd( Odd, _mm256_and_pd( _mm256_and_pd( Straddle, Left ), _mm256_cmp_pd( Cross, px, _CMP_LT_OQ ) ) );
+		}
+
+		Mask[i / 64] |= static_cast<uint64_t>(_mm256_movemask_pd( Odd )) << (i % 64);
+	}
+#endif
+
+	for ( ; i < Count; ++i )
+	{
+		if ( PointInPoly( CPoint2D( x[i], y[i] ) ) )
+			Mask[i / 64] |= uint64_t( 1 ) << (i % 64);
+	}
+}
+
+void
+CPoly2D::PointsOnPoly( const double* x,
+					   const double* y,
+					   size_t Count,
+					   uint64_t* Mask ) const
+{
+	std::fill( Mask, Mask + MaskWords( Count ), 0 );
+
+	size_t Corners = mPoints.size();
+	const double Tolerance = EPSILON * EPSILON;
+
+	// Within EPSILON of the line through an edge and not beyond its ends, or
+	// within EPSILON of an end, as PointOnPoly.  Compared squared.
+	auto On = [&]( double px,
+				   double py,
+				   const CPoint2D& a,
+				   const CPoint2D& b ) -> bool
+	{
+		double dx = b.x - a.x, dy = b.y - a.y;
+		double dd = dx * dx + dy * dy;
+		double c = (px - a.x) * dy - (py - a.y) * dx;
+
+		if ( c * c >= Tolerance * dd && dd != 0 )
+			return false;
+
+		double l1 = (px - a.x) * (px - a.x) + (py - a.y) * (py - a.y);
+		double l2 = (px - b.x) * (px - b.x) + (py - b.y) * (py - b.y);
+
+		return (l1 <= dd && l2 <= dd) || std::min( l1, l2 ) < Tolerance;
+	};
+
+	size_t i = 0;
+
+#ifdef __AVX2__
+	const __m256d Tol = _mm256_set1_pd( Tolerance );
+
+	for ( ; i + 4 <= Count; i += 4 )
+	{
+		__m256d px = _mm256_loadu_pd( x + i );
+		__m256d py = _mm256_loadu_pd( y + i );
+		__m256d Hit = _mm256_setzero_pd();
+		int Bits = 0;
+
+		for ( size_t c = 0; c < Corners; ++c )
+		{
+			const CPoint2D& a = mPoints[c];
+			const CPoint2D& b = mPoints[(c + 1) % Corners];
+
+			double dx = b.x - a.x, dy = b.y - a.y;
+			double dd = dx * dx + dy * dy;
+
+			// A degenerate edge is just its end
+			if ( dd == 0 )
+			{
+				for ( int k = 0; k < 4; ++k )
+					Bits |= On( x[i + k], y[i + k], a, b ) ? 1 << k : 0;
+
+				continue;
+			}
+
+			__m256d ux = _mm256_sub_pd( px, _mm256_set1_pd( a.x ) );
+			__m256d uy = _mm256_sub_pd( py, _mm256_set1_pd( a.y ) );
+			__m256d vx = _mm256_sub_pd( px, _mm256_set1_pd( b.x ) );
+			__m256d vy = _mm256_sub_pd( py, _mm256_set1_pd( b.y ) );
+			__m256d Length = _mm256_set1_pd( dd );
+
+			__m256d Cross = _mm256_sub_pd( _mm256_mul_pd( ux, _mm256_set1_pd( dy ) ), _mm256_mul_pd( uy, _mm256_set1_pd( dx ) ) );
+			__m256d Near = _mm256_cmp_pd( _mm256_mul_pd( Cross, Cross ), _mm256_mul_pd( Tol, Length ), _CMP_LT_OQ );
+
+			__m256d l1 = _mm256_add_pd( _mm256_mul_pd( ux, ux ), _mm256_mul_pd( uy, uy ) );
+			__m256d l2 = _mm256_add_pd( _mm256_mul_pd( vx, vx ), _mm256_mul_pd( vy, vy ) );
+
+			__m256d Within = _mm256_and_pd( _mm256_cmp_pd( l1, Length, _CMP_LE_OQ ), _mm256_cmp_pd( l2, Length, _CMP_LE_OQ ) );
+			__m256d AtEnd = _mm256_cmp_pd( _mm256_min_pd( l1, l2 ), Tol, _CMP_LT_OQ );
+
+			Hit = _mm256_or_pd( Hit, _mm256_and_pd( Near, _mm256_or_pd( Within, AtEnd ) ) );
+		}
+
+		Bits |= _mm256_movemask_pd( Hit );
+
+		Mask[i / 64] |= static_cast<uint64_t>(Bits) << (i % 64);
+	}
+#endif
+
+	for ( ; i < Count; ++i )
+	{
+		for ( size_t c = 0; c < Corners; ++c )
+		{
+			if ( On( x[i], y[i], mPoints[c], mPoints[(c + 1) % Corners] ) )
+			{
+				Mask[i / 64] |= uint64_t( 1 ) << (i % 64);
+				break;
+			}
+		}
+	}
+}
+
+bool
+CPoly2D::IsConvex() const
+{
+	return IsConvex( mPoints.data(), mPoints.size() );
+}
+
+bool
+CPoly2D::IsConvex( const CPoint2D* Points,
+				   size_t Count )
+{
+	// Every turn has the same sense, straight corners do not count
+	int Sense = 0;
+
+	for ( size_t i = 0; i < Count; ++i )
+	{
+		CVector2D a = Points[(i + 1) % Count] - Points[i];
+		CVector2D b = Points[(i + 2) % Count] - Points[(i + 1) % Count];
+
+		double Cross = a*b;
+
+		if ( abs( Cross ) < EPSILON )
+			continue;
+
+		int Turn = Cross > 0 ? 1 : -1;
+		if ( Sense != 0 && Turn != Sense )
+			return false;
+
+		Sense = Turn;
+	}
+
+	return true;
+}
+
 CPoly2D 
 CPoly2D::GetByPoint( const CPoint2D& Point,
 					 const std::vector<CPoly2D>& Polies )
@@ -654,4 +848,195 @@ CPoly2D::GetByPoint( const CPoint2D& Point,
 	}
 
 	return Result;
-}
\ No newline at end of file
+}
+size_t
+CPoly2D::ClipConvex( const CPoint2D* Points,
+					 size_t Count,
+					 const CLine2D& Line,
+					 CPoint2D* Result,
+					 size_t Capacity )
+{
+	CVector2D v = Line.P2() - Line.P1();
+	v.Normalize();
+
+	size_t Size = 0;
+
+	// Signed distance, left of the line is positive
+	auto Side = [&]( const CPoint2D& p ) -> double
+	{
+		return v*(p - Line.P1());
+	};
+
+	auto Add = [&]( const CPoint2D& p,
+					bool OnLine ) -> bool
+	{
+		if ( Size == Capacity )
+			return false;
+
+		Result[Size] = p;
+		Result[Size].mark = OnLine ? 1 : 0;
+		++Size;
+
+		return true;
+	};
+
+	for ( size_t i = 0; i < Count; ++i )
+	{
+		const CPoint2D& p1 = Points[(i + Count - 1) % Count];
+		const CPoint2D& p2 = Points[i];
+
+		double d1 = Side( p1 );
+		double d2 = Side( p2 );
+
+		// Only a proper crossing adds a point, a point on the line is kept
+		// as it is
+		if ( (d1 > EPSILON && d2 < -EPSILON) || (d1 < -EPSILON && d2 > EPSILON) )
+		{
+			if ( !Add( p1 + (p2 - p1) * (d1 / (d1 - d2)), true ) )
+				return kClipFailed;
+		}
+
+		if ( d2 >= -EPSILON && !Add( p2, d2 <= EPSILON ) )
+			return kClipFailed;
+	}
+
+	return Size < 3 ? 0 : Size;
+}
+
+size_t
+CPoly2D::ClipPiece( const CPoint2D* Points,
+					size_t Count,
+					const CLine2D& Line,
+					const CPoint2D& Point,
+					CPoint2D* Result,
+					size_t Capacity )
+{
+	// Sutherland-Hodgman leaves the pieces of a concave polygon joined by
+	// runs along the line.  Cutting those runs leaves chains that start and
+	// end on the line, the interior of the polygon on the line lies between
+	// consecutive chain ends so pairing them in order along the line joins
+	// the chains into the pieces.
+	CPoint2D Ring[kClipCapacity];
+	size_t Size = ClipConvex( Points, Count, Line, Ring, kClipCapacity );
+
+	if ( Size == kClipFailed || Size == 0 )
+		return Size;
+
+	auto OnLine = [&]( size_t i ) -> bool
+	{
+		return Ring[i % Size].mark == 1 && Ring[(i + 1) % Size].mark == 1;
+	};
+
+	// Ring[Begin, End] to Result from Written on, wrapping around
+	auto Copy = [&]( size_t Begin,
+					 size_t End,
+					 size_t Written ) -> size_t
+	{
+		for ( size_t i = Begin; ; i = (i + 1) % Size )
+		{
+			if ( Written == Capacity )
+				return kClipFailed;
+
+			Result[Written++] = Ring[i];
+
+			if ( i == End )
+				break;
+		}
+
+		return Written;
+	};
+
+	struct sEnd
+	{
+		double t;
+		size_t Chain;
+		bool Exit;
+	};
+
+	size_t Begin[kClipCapacity / 2];
+	size_t End[kClipCapacity / 2];
+	sEnd Ends[kClipCapacity];
+	size_t Chains = 0;
+
+	CVector2D v = Line.P2() - Line.P1();
+	v.Normalize();
+
+	for ( size_t i = 0; i < Size; ++i )
+	{
+		if ( !OnLine( i + Size - 1 ) || OnLine( i ) )
+			continue;
+
+		size_t j = i;
+		while ( !OnLine( j ) )
+			j = (j + 1) % Size;
+
+		Begin[Chains] = i;
+		End[Chains] = j;
+
+		Ends[2 * Chains] = { v.Dot( Ring[i] - Line.P1() ), Chains, false };
+		Ends[2 * Chains + 1] = { v.Dot( Ring[j] - Line.P1() ), Chains, true };
+		++Chains;
+	}
+
+	// Nothing runs along the line, the ring is a single piece
+	if ( Chains == 0 )
+	{
+		bool Inside = PointOnPoly( Ring, Size, Point ) > -1 || PointInPoly( Ring, Size, Point );
+
+		return Inside ? Copy( 0, Size - 1, 0 ) : 0;
+	}
+
+	std::sort( Ends, Ends + 2 * Chains,
+			   []( const sEnd& l, const sEnd& r )
+	{
+		return l.t < r.t;
+	}
+	);
+
+	size_t Next[kClipCapacity / 2];
+	bool Done[kClipCapacity / 2];
+
+	for ( size_t i = 0; i < 2 * Chains; i += 2 )
+	{
+		const sEnd& a = Ends[i];
+		const sEnd& b = Ends[i + 1];
+
+		if ( a.Exit == b.Exit )
+			return kClipFailed;
+
+		if ( a.Exit )
+			Next[a.Chain] = b.Chain;
+		else
+			Next[b.Chain] = a.Chain;
+	}
+
+	std::fill( Done, Done + Chains, false );
+
+	for ( size_t First = 0; First < Chains; ++First )
+	{
+		if ( Done[First] )
+			continue;
+
+		size_t Written = 0;
+		size_t Chain = First;
+
+		do
+		{
+			if ( Done[Chain] )
+				return kClipFailed;
+
+			Done[Chain] = true;
+
+			Written = Copy( Begin[Chain], End[Chain], Written );
+			if ( Written == kClipFailed )
+				return kClipFailed;
+
+			Chain = Next[Chain];
+		} while ( Chain != First );
+
+		if ( Written > 2 && (PointOnPoly( Result, Written, Point ) > -1 || PointInPoly( Result, Written, Point )) )
+			return Written;
+	}
+
+	return 0;
+}
@@ -8,6 +8,8 @@
 #include "Line2D.h"
 #include "Enums.h"
 
+#include <cstdint>
+
 class CPoly2D
 {
 public:
@@ -47,10 +49,61 @@ public:
 
 	bool PointInPoly( const CPoint2D& p ) const;
 	int PointOnPoly( const CPoint2D& p ) const;
+	bool IsConvex() const;
+
+	// Batch forms for the points (x[i], y[i]), bit i % 64 of Mask[i / 64] is
+	// set for point i.  Mask holds MaskWords( Count ) words.  Four points per
+	// lane with AVX2.
+	void PointsInPoly( const double* x,
+					   const double* y,
+					   size_t Count,
+					   uint64_t* Mask ) const;
+	void PointsOnPoly( const double* x,
+					   const double* y,
+					   size_t Count,
+					   uint64_t* Mask ) const;
+
+	static size_t MaskWords( size_t Count ) { return (Count + 63) / 64; };
 
 	static CPoly2D GetByPoint( const CPoint2D& Point,
 							   const std::vector<CPoly2D>& Polies );
 
+	// Clipping engine on caller buffers, nothing is allocated.  Keeps the
+	// part of Points[0, Count) left of Line in the input's winding, writes
+	// it to Result and returns the number of points, 0 if nothing is left or
+	// kClipFailed if Capacity or the scratch space is too small.  Points on
+	// the line are marked.
+	static const size_t kClipCapacity = 256;
+	static const size_t kClipFailed = static_cast<size_t>(-1);
+
+	// Sutherland-Hodgman, convex input
+	static size_t ClipConvex( const CPoint2D* Points,
+							  size_t Count,
+							  const CLine2D& Line,
+							  CPoint2D* Result,
+							  size_t Capacity );
+
+	// Any simple polygon, only the piece on or around Point is written
+	static size_t ClipPiece( const CPoint2D* Points,
+							 size_t Count,
+							 const CLine2D& Line,
+							 const CPoint2D& Point,
+							 CPoint2D* Result,
+							 size_t Capacity );
+
+	static double Area( const CPoint2D* Points,
+						size_t Count );
+	static CPoint2D Centroid( const CPoint2D* Points,
+							  size_t Count );
+	static bool PointInPoly( const CPoint2D* Points,
+							 size_t Count,
+							 const CPoint2D& p );
+	static int PointOnPoly( const CPoint2D* Points,
+							size_t Count,
+							const CPoint2D& p );
+	static bool IsConvex( const CPoint2D* Points,
+						  size_t Count );
+
 protected:
 	std::vector<CPoint2D> mPoints;
 	std::vector<eEdgeType> mEdgeTypes;
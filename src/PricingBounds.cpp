@@ -0,0 +1,271 @@
+// PricingBounds.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "PricingBounds.h"
+
+#include "Edge.h"
+#include "Node.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+CPricingBounds::CPricingBounds():
+	mCount( 0 ),
+	mCells( 0 )
+{
+}
+
+void
+CPricingBounds::Build( const std::vector<CEdge*>& Edges,
+					   size_t Count,
+					   const std::vector<CNode>& Nodes,
+					   const std::vector<double>& Live,
+					   const std::vector<double>& Dead )
+{
+	mGroups.clear();
+	mStart.clear();
+	mEdges.clear();
+	mRecords.clear();
+	mNodeCells.clear();
+
+	mCount = Count;
+	mCells = 0;
+
+	if ( Nodes.empty() )
+	{
+		mStart.push_back( 0 );
+		return;
+	}
+
+	CPoint2D Low = Nodes[0].Point;
+	CPoint2D High = Low;
+
+	for ( const auto& Node : Nodes )
+	{
+		Low.x = std::min( Low.x, Node.Point.x );
+		Low.y = std::min( Low.y, Node.Point.y );
+		High.x = std::max( High.x, Node.Point.x );
+		High.y = std::max( High.y, Node.Point.y );
+	}
+
+	// Square cells, about kCellNodes nodes each over the bounding box
+	double Width = std::max( High.x - Low.x, 1e-12 );
+	double Height = std::max( High.y - Low.y, 1e-12 );
+	double Side = std::ceil( std::sqrt( static_cast<double>(Nodes.size()) / kCellNodes ) );
+	double CellSize = std::max( Width, Height ) / Side;
+
+	size_t Columns = std::max<size_t>( static_cast<size_t>(std::ceil( Width / CellSize )), 1 );
+	size_t Rows = std::max<size_t>( static_cast<size_t>(std::ceil( Height / CellSize )), 1 );
+
+	mCells = Columns * Rows;
+	mBoxes.assign( 4 * mCells, 0.0 );
+	mNodeCells.resize( Nodes.size() );
+
+	for ( size_t n = 0; n < Nodes.size(); ++n )
+	{
+		double c = std::floor( (Nodes[n].Point.x - Low.x) / CellSize );
+		double r = std::floor( (Nodes[n].Point.y - Low.y) / CellSize );
+
+		size_t Column = static_cast<size_t>(std::min( std::max( c, 0.0 ), static_cast<double>(Columns - 1) ));
+		size_t Row = static_cast<size_t>(std::min( std::max( r, 0.0 ), static_cast<double>(Rows - 1) ));
+
+		mNodeCells[n] = static_cast<uint32_t>(Row * Columns + Column);
+	}
+
+	// Sorted by the cell pair, the edges of a group keep their order
+	std::vector<std::pair<uint64_t, uint32_t>> Keys;
+	Keys.reserve( Count );
+
+	for ( size_t i = 0; i < Count; ++i )
+	{
+		if ( !Edges[i]->Removeable )
+			continue;
+
+		uint64_t c1 = mNodeCells[Edges[i]->N1 - 1];
+		uint64_t c2 = mNodeCells[Edges[i]->N2 - 1];
+
+		Keys.push_back( { std::min( c1, c2 ) * mCells + std::max( c1, c2 ), static_cast<uint32_t>(i) } );
+	}
+
+	std::sort( Keys.begin(), Keys.end() );
+
+	mEdges.reserve( Keys.size() );
+	mRecords.reserve( Keys.size() );
+
+	const double Max = std::numeric_limits<double>::max();
+
+	for ( size_t i = 0; i < Keys.size(); ++i )
+	{
+		if ( i == 0 || Keys[i].first != Keys[i - 1].first )
+		{
+			mStart.push_back( i );
+			mGroups.push_back( { static_cast<uint32_t>(Keys[i].first / mCells),
+								 static_cast<uint32_t>(Keys[i].first % mCells),
+								 { Max, -Max }, { Max, -Max }, { Max, -Max }, { Max, -Max },
+								 false } );
+		}
+
+		uint32_t Index = Keys[i].second;
+		CEdge* Edge = Edges[Index];
+		sGroup& Group = mGroups.back();
+
+		double c, s;
+		Edge->GetDirection( c, s );
+
+		mEdges.push_back( Index );
+		mRecords.push_back( { static_cast<uint32_t>(Edge->N1),
+							  static_cast<uint32_t>(Edge->N2),
+							  c,
+							  s,
+							  Live[Index],
+							  Dead[Index],
+							  Edge->MpPos,
+							  Edge->MpNeg,
+							  Edge->Length } );
+
+		double Capacity = std::min( Edge->MpPos, Edge->MpNeg ) * Edge->Length;
+
+		if ( Capacity <= 0 )
+		{
+			Group.Unbounded = true;
+			continue;
+		}
+
+		double Scale = 1 / Capacity;
+
+		if ( mNodeCells[Edge->N1 - 1] != Group.Cell1 )
+		{
+			c = -c;
+			s = -s;
+		}
+
+		const double Values[4] = { c * Scale, s * Scale, Live[Index] * Scale, Dead[Index] * Scale };
+		double* Ranges[4] = { Group.c, Group.s, Group.Live, Group.Dead };
+
+		for ( size_t j = 0; j < 4; ++j )
+		{
+			Ranges[j][0] = std::min( Ranges[j][0], Values[j] );
+			Ranges[j][1] = std::max( Ranges[j][1], Values[j] );
+		}
+	}
+
+	mStart.push_back( Keys.size() );
+}
+
+void
+CPricingBounds::Update( const double* Forces )
+{
+	const double Max = std::numeric_limits<double>::max();
+
+	for ( size_t c = 0; c < mCells; ++c )
+	{
+		double* Box = &mBoxes[4 * c];
+
+		Box[0] = Box[2] = Max;
+		Box[1] = Box[3] = -Max;
+	}
+
+	for ( size_t n = 0; n < mNodeCells.size(); ++n )
+	{
+		double x = Forces[3 * n];
+		double y = Forces[3 * n + 1];
+		double* Box = &mBoxes[4 * mNodeCells[n]];
+
+		Box[0] = std::min( Box[0], x );
+		Box[1] = std::max( Box[1], x );
+		Box[2] = std::min( Box[2], y );
+		Box[3] = std::max( Box[3], y );
+	}
+}
+
+const uint32_t*
+CPricingBounds::GetEdges( size_t Group,
+						  size_t& Count ) const
+{
+	Count = mStart[Group + 1] - mStart[Group];
+
+	return &mEdges[mStart[Group]];
+}
+
+// Range of the product of two ranges
+static void
+fMultiply( const double* a,
+		   const double* b,
+		   double* Result )
+{
+	double p[4] = { a[0] * b[0], a[0] * b[1], a[1] * b[0], a[1] * b[1] };
+
+	Result[0] = std::min( std::min( p[0], p[1] ), std::min( p[2], p[3] ) );
+	Result[1] = std::max( std::max( p[0], p[1] ), std::max( p[2], p[3] ) );
+}
+
+double
+CPricingBounds::GetBound( size_t Group,
+						  double Lambda ) const
+{
+	const sGroup& Entry = mGroups[Group];
+
+	if ( Entry.Unbounded )
+		return std::numeric_limits<double>::infinity();
+
+	const double* Box1 = &mBoxes[4 * Entry.Cell1];
+	const double* Box2 = &mBoxes[4 * Entry.Cell2];
+
+	// Force differences between a node of the first and of the second cell
+	const double dx[2] = { Box1[0] - Box2[1], Box1[1] - Box2[0] };
+	const double dy[2] = { Box1[2] - Box2[3], Box1[3] - Box2[2] };
+	const double Factor[2] = { Lambda, Lambda };
+
+	double x[2], y[2], Live[2];
+	fMultiply( Entry.c, dx, x );
+	fMultiply( Entry.s, dy, y );
+	fMultiply( Entry.Live, Factor, Live );
+
+	double Low = x[0] + y[0] + Live[0] + Entry.Dead[0];
+	double High = x[1] + y[1] + Live[1] + Entry.Dead[1];
+
+	return std::max( -Low, High );
+}
+
+double
+CPricingBounds::Price( size_t Group,
+					   const double* Forces,
+					   double Lambda,
+					   const std::vector<CEdge*>& Edges ) const
+{
+	double Result = 0;
+
+	for ( size_t i = mStart[Group]; i < mStart[Group + 1]; ++i )
+	{
+		const sEdge& Edge = mRecords[i];
+
+		const double* F1 = Forces + 3 * Edge.N1 - 3;
+		const double* F2 = Forces + 3 * Edge.N2 - 3;
+
+		// The terms of CDLOSolver::fGetYieldRatio in the same order, the
+		// ratio does not depend on which of the two is used
+		double Mn = 0;
+
+		Mn += Edge.c * F1[0];
+		Mn += Edge.s * F1[1];
+		Mn += -Edge.c * F2[0];
+		Mn += -Edge.s * F2[1];
+
+		Mn += Lambda * Edge.Live;
+		Mn += Edge.Dead;
+
+		double Ratio;
+		if ( Mn < 0 )
+			Ratio = std::abs( Mn / (Edge.MpNeg * Edge.Length) );
+		else
+			Ratio = std::abs( Mn / (Edge.MpPos * Edge.Length) );
+
+		Edges[mEdges[i]]->YieldRatio = Ratio;
+		Result = std::max( Result, Ratio );
+	}
+
+	return Result;
+}
@@ -0,0 +1,98 @@
+// PricingBounds.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CEdge;
+class CNode;
+
+// Upper bounds of the yield ratio for groups of candidate edges.  The nodes
+// are binned into the cells of a uniform grid, a few nodes per cell, and
+// the edges grouped by the cells of their two nodes.  Per unit capacity the
+// normal moment of an edge is its direction times the in-plane force
+// difference of its nodes plus the load work, both terms are bounded by
+// intervals over the group.  The intervals keep their signs, near collapse
+// the two terms cancel.  The edges of a group that can yield are priced
+// from compact records in group order, without the compatibility matrix of
+// the edge.
+class CPricingBounds
+{
+public:
+	// Nodes per grid cell on average, small cells keep the force boxes and
+	// the directions of a group tight enough for the bound to fire
+	static const size_t kCellNodes = 2;
+
+	CPricingBounds();
+	virtual ~CPricingBounds() {};
+
+	// Groups the removeable edges among the first Count, Live and Dead are
+	// the unit load work in the normal moment DOF of every edge
+	void Build( const std::vector<CEdge*>& Edges,
+				size_t Count,
+				const std::vector<CNode>& Nodes,
+				const std::vector<double>& Live,
+				const std::vector<double>& Dead );
+
+	// Boxes of the in-plane forces of every cell, node n at 3n - 3
+	void Update( const double* Forces );
+
+	size_t GetGroups() const { return mGroups.size(); };
+	size_t GetEdgeCount() const { return mCount; };
+	const uint32_t* GetEdges( size_t Group,
+							  size_t& Count ) const;
+	double GetBound( size_t Group,
+					 double Lambda ) const;
+
+	// Sets the yield ratio of every edge of the group, returns the largest
+	double Price( size_t Group,
+				  const double* Forces,
+				  double Lambda,
+				  const std::vector<CEdge*>& Edges ) const;
+
+protected:
+	struct sGroup
+	{
+		uint32_t Cell1, Cell2;
+
+		// Ranges of the direction and of the unit live and dead load work
+		// over min( MpPos, MpNeg ) * Length, the direction points from the
+		// node in Cell1 to the node in Cell2
+		double c[2], s[2];
+		double Live[2];
+		double Dead[2];
+
+		// An edge without capacity, the group is always priced
+		bool Unbounded;
+	};
+
+	std::vector<sGroup> mGroups;
+	size_t mCount;
+	size_t mCells;
+
+	// Grid cell of node n at n - 1
+	std::vector<uint32_t> mNodeCells;
+
+	// Normal moment DOF of an edge: direction, unit load work and capacity
+	struct sEdge
+	{
+		uint32_t N1, N2;
+		double c, s;
+		double Live, Dead;
+		double MpPos, MpNeg;
+		double Length;
+	};
+
+	// Edges of group g at [mStart[g], mStart[g + 1]), by index in the edge
+	// list and as records
+	std::vector<size_t> mStart;
+	std::vector<uint32_t> mEdges;
+	std::vector<sEdge> mRecords;
+
+	// Smallest and largest x and y force of cell c at 4 * c
+	std::vector<double> mBoxes;
+};
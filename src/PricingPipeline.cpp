@@ -0,0 +1,174 @@
+// PricingPipeline.cpp
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#include "PricingPipeline.h"
+
+#include "Edge.h"
+
+#include <algorithm>
+
+static const double kYieldZero = 1e-6;
+static const double kStrongYield = 1.1;
+static const size_t kChunk = 64;
+
+CPricingPipeline::CPricingPipeline( int Threads,
+									tPricer Pricer ):
+	mThreads( std::max( Threads, 1 ) ),
+	mPricer( Pricer ),
+	mNext( 0 ),
+	mPriced( 0 ),
+	mStrong( 0 ),
+	mSweep( 0 ),
+	mRunning( 0 ),
+	mStop( false )
+{
+	for ( int i = 0; i < mThreads; ++i )
+		mWorkers.push_back( std::thread( &CPricingPipeline::fWork, this ) );
+}
+
+CPricingPipeline::~CPricingPipeline()
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> Lock( mMutex );
+		mStop = true;
+	}
+
+	mStarted.notify_all();
+
+	for ( auto& Worker : mWorkers )
+		Worker.join();
+}
+
+void
+CPricingPipeline::Start( const std::vector<CEdge*>& Candidates )
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> Lock( mMutex );
+
+		mCandidates = Candidates;
+		mNext = 0;
+		mPriced = 0;
+		mViolated.clear();
+		mStrong = 0;
+		mRunning = mThreads;
+		++mSweep;
+	}
+
+	mStarted.notify_all();
+}
+
+void
+CPricingPipeline::fWork()
+{
+	std::vector<double> Row = { 0,0,0 };
+	std::vector<std::vector<double>> B;
+	B.resize( 6, Row );
+
+	std::vector<std::pair<CEdge*, double>> Violated;
+	size_t Sweep = 0;
+
+	for ( ;; )
+	{
+		{
+			std::unique_lock<std::mutex> Lock( mMutex );
+
+			mStarted.wait( Lock, [&]()
+			{
+				return mStop || mSweep != Sweep;
+			} );
+
+			if ( mStop )
+				return;
+
+			Sweep = mSweep;
+		}
+
+		for ( ;; )
+		{
+			size_t Begin = mNext.fetch_add( kChunk );
+			if ( Begin >= mCandidates.size() )
+				break;
+
+			size_t End = std::min( Begin + kChunk, mCandidates.size() );
+			size_t Strong = 0;
+
+			Violated.clear();
+
+			for ( size_t i = Begin; i < End; ++i )
+			{
+				double Ratio = mPricer( mCandidates[i], B );
+
+				if ( Ratio - 1.0 > kYieldZero )
+				{
+					Violated.push_back( std::make_pair( mCandidates[i], Ratio ) );
+
+					if ( Ratio > kStrongYield )
+						++Strong;
+				}
+			}
+
+			mPriced += End - Begin;
+
+			if ( Violated.size() )
+			{
+				std::lock_guard<std::mutex> Lock( mMutex );
+				mViolated.insert( mViolated.end(), Violated.begin(), Violated.end() );
+				mStrong += Strong;
+			}
+
+			if ( Strong )
+				mChanged.notify_all();
+		}
+
+		{
+			std::lock_guard<std::mutex> Lock( mMutex );
+			--mRunning;
+		}
+
+		mChanged.notify_all();
+	}
+}
+
+bool
+CPricingPipeline::WaitFor( size_t Wanted )
+{
+	std::unique_lock<std::mutex> Lock( mMutex );
+
+	mChanged.wait( Lock, [&]()
+	{
+		return mRunning == 0 || mStrong >= Wanted;
+	} );
+
+	return mRunning == 0;
+}
+
+void
+CPricingPipeline::Wait()
+{
+	std::unique_lock<std::mutex> Lock( mMutex );
+
+	mChanged.wait( Lock, [&]()
+	{
+		return mRunning == 0;
+	} );
+}
+
+void
+CPricingPipeline::Drain( std::vector<CEdge*>& Edges )
+{
+	std::lock_guard<std::mutex> Lock( mMutex );
+
+	// A worker is done with an edge once it is queued
+	for ( auto& Violated : mViolated )
+	{
+		Violated.first->YieldRatio = Violated.second;
+		Edges.push_back( Violated.first );
+	}
+
+	mViolated.clear();
+}
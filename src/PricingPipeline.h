@@ -0,0 +1,61 @@
+// PricingPipeline.h
+// Copyright (c) 2022, Renier Cloete
+// This program is released under the BSD license. See the file LICENSE.txt for details.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class CEdge;
+
+// Prices a snapshot of candidate edges on worker threads.  Workers only read
+// the edges, the yield ratios of violated edges are written by Drain on the
+// calling thread, so the caller may keep building and solving the LP over
+// the admitted edges while a sweep runs.  The workers are started once and
+// wait for the next sweep between the iterations.
+class CPricingPipeline
+{
+public:
+	typedef std::function<double( CEdge* Edge, std::vector<std::vector<double>>& B )> tPricer;
+
+	CPricingPipeline( int Threads,
+					  tPricer Pricer );
+	virtual ~CPricingPipeline();
+
+	void Start( const std::vector<CEdge*>& Candidates );
+
+	// Blocks until Wanted strongly violated edges are queued or the sweep is
+	// complete, returns true for a complete sweep
+	bool WaitFor( size_t Wanted );
+	void Wait();
+
+	void Drain( std::vector<CEdge*>& Edges );
+
+	size_t GetPriced() { return mPriced; };
+
+protected:
+	int mThreads;
+	std::vector<std::thread> mWorkers;
+
+	std::vector<CEdge*> mCandidates;
+	tPricer mPricer;
+	std::atomic<size_t> mNext;
+	std::atomic<size_t> mPriced;
+
+	std::mutex mMutex;
+	std::condition_variable mChanged;
+	std::condition_variable mStarted;
+	std::vector<std::pair<CEdge*, double>> mViolated;
+	size_t mStrong;
+	size_t mSweep;
+	int mRunning;
+	bool mStop;
+
+	void fWork();
+};
@@ -4,7 +4,7 @@
 
 #pragma once
 
-#include "Point2d.h"
+#include "Point2D.h"
 
 using CVector2D=CPoint2D;
 